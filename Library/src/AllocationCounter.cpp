@@ -0,0 +1,91 @@
+#include "AllocationCounter.h"
+
+//Standard includes
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace dae
+{
+	namespace AllocationCounter
+	{
+		//relaxed, only the total matters
+		static std::atomic<uint64_t> allocationCount{};
+
+		uint64_t GetCount()
+		{
+			return allocationCount.load(std::memory_order_relaxed);
+		}
+
+		static void* Allocate(std::size_t size)
+		{
+			allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+			//malloc(0) may return nullptr, new never does
+			void* pMemory{ std::malloc(size == 0 ? 1 : size) };
+			if (!pMemory)
+			{
+				throw std::bad_alloc{};
+			}
+			return pMemory;
+		}
+
+		static void* AllocateAligned(std::size_t size, std::size_t alignment)
+		{
+			allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _WIN32
+			void* pMemory{ _aligned_malloc(size == 0 ? 1 : size, alignment) };
+#else
+			//aligned_alloc wants the size to be a multiple of the alignment
+			void* pMemory{ std::aligned_alloc(alignment, (size + alignment) / alignment * alignment) };
+#endif
+			if (!pMemory)
+			{
+				throw std::bad_alloc{};
+			}
+			return pMemory;
+		}
+
+		static void FreeAligned(void* pMemory)
+		{
+#ifdef _WIN32
+			_aligned_free(pMemory);
+#else
+			std::free(pMemory);
+#endif
+		}
+	}
+}
+
+//the array & nothrow versions of the standard library forward to these
+void* operator new(std::size_t size)
+{
+	return dae::AllocationCounter::Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return dae::AllocationCounter::AllocateAligned(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	std::free(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+	dae::AllocationCounter::FreeAligned(pMemory);
+}
+
+//the default sized versions may not forward to the replaced unsized ones
+void operator delete(void* pMemory, std::size_t) noexcept
+{
+	operator delete(pMemory);
+}
+
+void operator delete(void* pMemory, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(pMemory, alignment);
+}
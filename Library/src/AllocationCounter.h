@@ -0,0 +1,15 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+
+namespace dae
+{
+	//AllocationCounter.cpp replaces the global operator new & delete => every heap allocation of the program gets counted
+	//only when Library is linked statically (x64), the Win32 Library.dll only counts its own allocations
+	namespace AllocationCounter
+	{
+		//allocations since startup, from every thread
+		uint64_t GetCount();
+	}
+}
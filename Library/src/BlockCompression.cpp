@@ -0,0 +1,189 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+namespace dae
+{
+	//rounded to the nearest 5/6/5 bit value
+	static uint16_t ToRgb565(const float color[3])
+	{
+		const auto quantize{ [](float channel, int maxValue)
+			{
+				return static_cast<uint16_t>(std::clamp(static_cast<int>(channel * maxValue / 255.f + 0.5f), 0, maxValue));
+			} };
+
+		return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+	}
+
+	static int SquaredDistance(uint32_t texel0, uint32_t texel1)
+	{
+		int distance{};
+		for (int shift{}; shift < 24; shift += 8)
+		{
+			const int difference{ static_cast<int>((texel0 >> shift) & 0xFF) - static_cast<int>((texel1 >> shift) & 0xFF) };
+			distance += difference * difference;
+		}
+		return distance;
+	}
+
+	Bc1Block EncodeBc1(const uint32_t texels[16])
+	{
+		float colors[16][3]{};
+		float mean[3]{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			for (int channelIdx{}; channelIdx < 3; ++channelIdx)
+			{
+				colors[texelIdx][channelIdx] = static_cast<float>((texels[texelIdx] >> (channelIdx * 8)) & 0xFF);
+				mean[channelIdx] += colors[texelIdx][channelIdx] / 16.f;
+			}
+		}
+
+		//covariance => rr, rg, rb, gg, gb, bb
+		float covariance[6]{};
+		for (const float* pColor : colors)
+		{
+			const float r{ pColor[0] - mean[0] };
+			const float g{ pColor[1] - mean[1] };
+			const float b{ pColor[2] - mean[2] };
+			covariance[0] += r * r;
+			covariance[1] += r * g;
+			covariance[2] += r * b;
+			covariance[3] += g * g;
+			covariance[4] += g * b;
+			covariance[5] += b * b;
+		}
+
+		//the colors mostly lie on a line through the mean, power iteration finds its direction
+		float axis[3]{ 1.f, 1.f, 1.f };
+		for (int iteration{}; iteration < 8; ++iteration)
+		{
+			const float x{ covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2] };
+			const float y{ covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2] };
+			const float z{ covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2] };
+			const float length{ std::max(std::abs(x), std::max(std::abs(y), std::abs(z))) };
+
+			//flat block, any direction will do
+			if (length < 1e-6f)
+			{
+				break;
+			}
+
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		//end points are the outermost colors projected on the line
+		float minProjection{ FLT_MAX };
+		float maxProjection{ -FLT_MAX };
+		for (const float* pColor : colors)
+		{
+			const float projection{ (pColor[0] - mean[0]) * axis[0] + (pColor[1] - mean[1]) * axis[1] + (pColor[2] - mean[2]) * axis[2] };
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		const float axisSqrLength{ axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] };
+		float endPoint0[3]{};
+		float endPoint1[3]{};
+		for (int channelIdx{}; channelIdx < 3; ++channelIdx)
+		{
+			endPoint0[channelIdx] = mean[channelIdx] + axis[channelIdx] * maxProjection / axisSqrLength;
+			endPoint1[channelIdx] = mean[channelIdx] + axis[channelIdx] * minProjection / axisSqrLength;
+		}
+
+		Bc1Block block{ ToRgb565(endPoint0), ToRgb565(endPoint1), 0 };
+
+		//color0 > color1 picks the 4 color mode, equal end points can only be a flat block => every index 0
+		if (block.color0 == block.color1)
+		{
+			return block;
+		}
+		if (block.color0 < block.color1)
+		{
+			std::swap(block.color0, block.color1);
+		}
+
+		//indices are picked against the decoded palette, that's what the decoder will blend
+		uint32_t palette[4]{};
+		for (int index{}; index < 4; ++index)
+		{
+			Bc1Block paletteBlock{ block.color0, block.color1, static_cast<uint32_t>(index) };
+			palette[index] = DecodeBc1(paletteBlock, 0);
+		}
+
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			uint32_t bestIndex{};
+			int bestDistance{ INT_MAX };
+			for (uint32_t index{}; index < 4; ++index)
+			{
+				const int distance{ SquaredDistance(texels[texelIdx], palette[index]) };
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = index;
+				}
+			}
+			block.indices |= bestIndex << (texelIdx * 2);
+		}
+
+		return block;
+	}
+
+	Bc3Block EncodeBc3(const uint32_t texels[16])
+	{
+		Bc3Block block{};
+		block.color = EncodeBc1(texels);
+
+		uint8_t minAlpha{ 255 };
+		uint8_t maxAlpha{ 0 };
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			const uint8_t alpha{ static_cast<uint8_t>(texels[texelIdx] >> 24) };
+			minAlpha = std::min(minAlpha, alpha);
+			maxAlpha = std::max(maxAlpha, alpha);
+		}
+
+		//alpha0 > alpha1 picks the 8 alpha mode, a flat block keeps every index 0
+		block.alpha0 = maxAlpha;
+		block.alpha1 = minAlpha;
+		if (maxAlpha == minAlpha)
+		{
+			return block;
+		}
+
+		//index 0 & 1 are the end points, 2 to 7 step from alpha0 to alpha1
+		int palette[8]{};
+		for (int index{}; index < 8; ++index)
+		{
+			Bc3Block paletteBlock{ block.alpha0, block.alpha1, { static_cast<uint8_t>(index) } };
+			palette[index] = static_cast<int>(DecodeBc3(paletteBlock, 0) >> 24);
+		}
+
+		uint64_t alphaIndices{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			const int alpha{ static_cast<int>(texels[texelIdx] >> 24) };
+
+			uint64_t bestIndex{};
+			int bestDistance{ INT_MAX };
+			for (uint64_t index{}; index < 8; ++index)
+			{
+				const int distance{ std::abs(palette[index] - alpha) };
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = index;
+				}
+			}
+			alphaIndices |= bestIndex << (texelIdx * 3);
+		}
+		std::memcpy(block.alphaIndices, &alphaIndices, sizeof(block.alphaIndices));
+
+		return block;
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <cstring>
+
+namespace dae
+{
+	//how a Texture keeps its texels in memory
+	enum class TextureFormat
+	{
+		//4 bytes per texel, lossless
+		RGBA8,
+		//RGB in 4x4 blocks of 8 bytes => 0.5 bytes per texel, no alpha
+		BC1,
+		//BC1 colors + 8 byte alpha blocks => 1 byte per texel
+		BC3
+	};
+
+	//4x4 texels, 2 RGB565 end points & a 2 bit index per texel picking a color in between
+	struct Bc1Block
+	{
+		uint16_t color0{};
+		uint16_t color1{};
+		uint32_t indices{};
+	};
+
+	//4x4 texels, BC1 colors & 2 alpha end points with a 3 bit index per texel
+	struct Bc3Block
+	{
+		uint8_t alpha0{};
+		uint8_t alpha1{};
+		uint8_t alphaIndices[6]{};
+		Bc1Block color{};
+	};
+
+	//texels of a block are row by row => texelIdx = x + y * 4, texels are 0xAABBGGRR like Texture
+	Bc1Block EncodeBc1(const uint32_t texels[16]);
+	Bc3Block EncodeBc3(const uint32_t texels[16]);
+
+	//5 or 6 bits to 8 bits, the top bits repeat in the bottom ones so 0 & max stay 0 & 255
+	inline uint32_t Rgb565ToTexel(uint16_t color)
+	{
+		const uint32_t r{ static_cast<uint32_t>((color >> 11) & 0x1F) };
+		const uint32_t g{ static_cast<uint32_t>((color >> 5) & 0x3F) };
+		const uint32_t b{ static_cast<uint32_t>(color & 0x1F) };
+		return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xFF000000;
+	}
+
+	//(texel0 * weight0 + texel1 * weight1) / (weight0 + weight1) per color channel, rounded
+	inline uint32_t BlendTexels(uint32_t texel0, uint32_t texel1, uint32_t weight0, uint32_t weight1)
+	{
+		const uint32_t weightSum{ weight0 + weight1 };
+
+		uint32_t texel{ 0xFF000000 };
+		for (int shift{}; shift < 24; shift += 8)
+		{
+			const uint32_t channel{ ((((texel0 >> shift) & 0xFF) * weight0) + (((texel1 >> shift) & 0xFF) * weight1) + (weightSum / 2)) / weightSum };
+			texel |= channel << shift;
+		}
+		return texel;
+	}
+
+	inline uint32_t DecodeBc1(const Bc1Block& block, int texelIdx)
+	{
+		const uint32_t texel0{ Rgb565ToTexel(block.color0) };
+		const uint32_t texel1{ Rgb565ToTexel(block.color1) };
+		const uint32_t index{ (block.indices >> (texelIdx * 2)) & 0x3 };
+
+		if (index < 2)
+		{
+			return (index == 0) ? texel0 : texel1;
+		}
+
+		//color0 <= color1 => 3 colors & transparent black, the encoder only writes that for flat blocks
+		if (block.color0 <= block.color1)
+		{
+			return (index == 2) ? BlendTexels(texel0, texel1, 1, 1) : 0;
+		}
+		return (index == 2) ? BlendTexels(texel0, texel1, 2, 1) : BlendTexels(texel0, texel1, 1, 2);
+	}
+
+	//adds weight * the color of a texel to rgb, filtering doesn't need it rounded & packed like DecodeBc1 does
+	inline void AccumulateBc1(const Bc1Block& block, int texelIdx, float weight, float rgb[3])
+	{
+		//weights of color0 & color1 per index, 4 color mode first
+		static constexpr float weights0[2][4]{ { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f }, { 1.f, 0.f, 0.5f, 0.f } };
+		static constexpr float weights1[2][4]{ { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f }, { 0.f, 1.f, 0.5f, 0.f } };
+
+		const uint32_t index{ (block.indices >> (texelIdx * 2)) & 0x3 };
+		const int mode{ block.color0 <= block.color1 };
+		const float weight0{ weights0[mode][index] * weight };
+		const float weight1{ weights1[mode][index] * weight };
+
+		//5 & 6 bits straight to [0, 255], the bit repeat of Rgb565ToTexel lands within half a step of it
+		constexpr float fiveBitsToByte{ 255.f / 31.f };
+		constexpr float sixBitsToByte{ 255.f / 63.f };
+		rgb[0] += ((block.color0 >> 11) * weight0 + (block.color1 >> 11) * weight1) * fiveBitsToByte;
+		rgb[1] += (((block.color0 >> 5) & 0x3F) * weight0 + ((block.color1 >> 5) & 0x3F) * weight1) * sixBitsToByte;
+		rgb[2] += ((block.color0 & 0x1F) * weight0 + (block.color1 & 0x1F) * weight1) * fiveBitsToByte;
+	}
+
+	inline uint32_t DecodeBc3Alpha(const Bc3Block& block, int texelIdx)
+	{
+		//48 bits of 3 bit indices
+		uint64_t alphaIndices{};
+		std::memcpy(&alphaIndices, block.alphaIndices, sizeof(block.alphaIndices));
+		const uint32_t alphaIdx{ static_cast<uint32_t>(alphaIndices >> (texelIdx * 3)) & 0x7 };
+
+		//alpha0 > alpha1 => 6 alphas in between, else 4 & 0 & 255, the encoder only uses the second mode for flat blocks
+		if (alphaIdx == 0)
+		{
+			return block.alpha0;
+		}
+		if (alphaIdx == 1)
+		{
+			return block.alpha1;
+		}
+		if (block.alpha0 > block.alpha1)
+		{
+			return ((8 - alphaIdx) * block.alpha0 + (alphaIdx - 1) * block.alpha1 + 3) / 7;
+		}
+		return (alphaIdx == 6) ? 0 : (alphaIdx == 7) ? 255 : ((6 - alphaIdx) * block.alpha0 + (alphaIdx - 1) * block.alpha1 + 2) / 5;
+	}
+
+	inline uint32_t DecodeBc3(const Bc3Block& block, int texelIdx)
+	{
+		return (DecodeBc1(block.color, texelIdx) & 0x00FFFFFF) | (DecodeBc3Alpha(block, texelIdx) << 24);
+	}
+
+	//alpha += weight * the alpha of a texel, like AccumulateBc1
+	inline void AccumulateBc3Alpha(const Bc3Block& block, int texelIdx, float weight, float& alpha)
+	{
+		//weights of alpha0 & alpha1 per index & what gets added on top, 8 alpha mode first
+		static constexpr float weights0[2][8]{ { 1.f, 0.f, 6.f / 7.f, 5.f / 7.f, 4.f / 7.f, 3.f / 7.f, 2.f / 7.f, 1.f / 7.f }, { 1.f, 0.f, 4.f / 5.f, 3.f / 5.f, 2.f / 5.f, 1.f / 5.f, 0.f, 0.f } };
+		static constexpr float weights1[2][8]{ { 0.f, 1.f, 1.f / 7.f, 2.f / 7.f, 3.f / 7.f, 4.f / 7.f, 5.f / 7.f, 6.f / 7.f }, { 0.f, 1.f, 1.f / 5.f, 2.f / 5.f, 3.f / 5.f, 4.f / 5.f, 0.f, 0.f } };
+		static constexpr float offsets[2][8]{ {}, { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 255.f } };
+
+		//alpha0, alpha1 & the 48 index bits in one load
+		uint64_t alphaBits{};
+		std::memcpy(&alphaBits, &block, sizeof(alphaBits));
+		const uint32_t alphaIdx{ static_cast<uint32_t>(alphaBits >> (16 + texelIdx * 3)) & 0x7 };
+		const int mode{ block.alpha0 <= block.alpha1 };
+
+		alpha += (block.alpha0 * weights0[mode][alphaIdx] + block.alpha1 * weights1[mode][alphaIdx] + offsets[mode][alphaIdx]) * weight;
+	}
+
+	//rgba += weight * texel, like AccumulateBc1
+	inline void AccumulateBc3(const Bc3Block& block, int texelIdx, float weight, float rgba[4])
+	{
+		AccumulateBc1(block.color, texelIdx, weight, rgba);
+		AccumulateBc3Alpha(block, texelIdx, weight, rgba[3]);
+	}
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "Maths.h"
+#include "SimdMath.h"
 #include "vector"
+#include <algorithm>
 
 namespace dae
 {
@@ -14,29 +16,143 @@ namespace dae
 		Vector3 viewDirection{}; //W4
 	};
 
+	//vertex stage output, kept small => less memory traffic per triangle
 	struct Vertex_Out
 	{
+		//screen x & y, NDC depth & 1 / w for the perspective correct interpolation
 		Vector4 position{};
-		ColorRGB color{ colors::White };
 		Vector2 uv{};
-		Vector3 normal{};
-		Vector3 tangent{};
+		//unit vectors, octahedral encoded by EncodeUnitVector
+		uint32_t normal{};
+		uint32_t tangent{};
 		Vector3 viewDirection{};
 	};
 
+	//a unit vector in 32 bits: projected on the octahedron |x| + |y| + |z| = 1 with the lower half folded over the upper one,
+	//x & y of that are 16 bit snorms => off by less than 0.01 degrees
+	inline uint32_t EncodeUnitVector(const Vector3& v)
+	{
+		const float length{ std::abs(v.x) + std::abs(v.y) + std::abs(v.z) };
+		//zero length or NaN (degenerate uvs give NaN tangents) => +z
+		if (!(length > 0.f))
+		{
+			return 0;
+		}
+
+		float x{ v.x / length };
+		float y{ v.y / length };
+		if (v.z < 0.f)
+		{
+			const float foldedX{ (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f) };
+			const float foldedY{ (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f) };
+			x = foldedX;
+			y = foldedY;
+		}
+
+		const auto toSnorm{ [](float value)
+			{
+				return static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(std::round(Clamp(value, -1.f, 1.f) * 32767.f))));
+			} };
+		return toSnorm(x) | (toSnorm(y) << 16);
+	}
+
+	inline Vector3 DecodeUnitVector(uint32_t encoded)
+	{
+		const float x{ static_cast<int16_t>(encoded & 0xFFFF) / 32767.f };
+		const float y{ static_cast<int16_t>(encoded >> 16) / 32767.f };
+		const float z{ 1.f - std::abs(x) - std::abs(y) };
+
+		//unfold the lower half
+		const float fold{ std::max(-z, 0.f) };
+		return Vector3{ x + (x >= 0.f ? -fold : fold), y + (y >= 0.f ? -fold : fold), z }.Normalized();
+	}
+
+	//the vertex components the vertex stage reads, split in one array per component
+	//=> 4 or 8 vertices get loaded with one instruction per component
+	struct VertexStreams
+	{
+		//arrays are padded with zeros to a multiple of this, the last load never reads past the end
+		static constexpr size_t PADDING{ 8 };
+
+		//without the padding
+		size_t vertexCount{};
+		std::vector<float> positionX{};
+		std::vector<float> positionY{};
+		std::vector<float> positionZ{};
+		std::vector<float> normalX{};
+		std::vector<float> normalY{};
+		std::vector<float> normalZ{};
+		std::vector<float> tangentX{};
+		std::vector<float> tangentY{};
+		std::vector<float> tangentZ{};
+		std::vector<float> uvX{};
+		std::vector<float> uvY{};
+	};
+
+	namespace Simd
+	{
+		//Vertex_Out for a block of pixels, one lane per pixel
+		template<typename Float>
+		struct Vertex_Out
+		{
+			Vector2<Float> uv{};
+			Vector3<Float> normal{};
+			Vector3<Float> tangent{};
+			Vector3<Float> viewDirection{};
+		};
+
+		//EncodeUnitVector for a vector per lane, the lanes hold the encoded bits
+		template<typename Float>
+		inline Float EncodeUnitVector(const Vector3<Float>& v)
+		{
+			const Float length{ Abs(v.x) + Abs(v.y) + Abs(v.z) };
+			const Float invLength{ Float{ 1.f } / length };
+			const Float x{ v.x * invLength };
+			const Float y{ v.y * invLength };
+
+			//fold the lower half over the upper one
+			const Float isLowerHalf{ v.z < 0.f };
+			const Float foldedX{ (Float{ 1.f } - Abs(y)) * Select(x >= 0.f, Float{ 1.f }, Float{ -1.f }) };
+			const Float foldedY{ (Float{ 1.f } - Abs(x)) * Select(y >= 0.f, Float{ 1.f }, Float{ -1.f }) };
+			const Float encoded{ PackSnorm16(Select(isLowerHalf, foldedX, x), Select(isLowerHalf, foldedY, y)) };
+
+			//zero length or NaN => 0 like the scalar version
+			return Select(length > 0.f, encoded, Float{ 0.f });
+		}
+	}
+
 	enum class PrimitiveTopology
 	{
 		TriangleList,
 		TriangleStrip
 	};
 
+	//which triangles get skipped before rasterization, front faces are counter-clockwise on screen
+	enum class CullMode
+	{
+		None,
+		Back,
+		Front
+	};
+
 	struct Mesh
 	{
 		std::vector<Vertex> vertices{};
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleList };
+		CullMode cullMode{ CullMode::Back };
+		//object space bounding box
+		Vector3 boundsMin{};
+		Vector3 boundsMax{};
+		//object space bounding sphere around the center of the box
+		Vector3 boundsCenter{};
+		float boundsRadius{};
+		//the vertices as streams, the vertex stage & clipping only read these => the renderer releases vertices once they're built
+		//a mesh loaded from its cache only has the streams
+		VertexStreams vertexStreams{};
 
-		std::vector<Vertex_Out> vertices_out{};
 		Matrix worldMatrix{};
+		//set by frustum culling every frame, an invisible mesh skips the vertex stage & binning
+		bool isVisible{ true };
 	};
 }
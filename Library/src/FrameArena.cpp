@@ -0,0 +1,107 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <numeric>
+
+namespace dae
+{
+	FrameArena::FrameArena(size_t blockSize)
+		: m_BlockSize{ blockSize }
+	{
+	}
+
+	FrameArena::FrameArena(FrameArena& parent, size_t chunkSize)
+		: m_pParent{ &parent }
+		, m_BlockSize{ chunkSize }
+	{
+	}
+
+	FrameArena::~FrameArena()
+	{
+		for (std::byte* pBlock : m_pBlocks)
+		{
+			delete[] pBlock;
+		}
+	}
+
+	void* FrameArena::Allocate(size_t size, size_t alignment)
+	{
+		if (m_pParent)
+		{
+			return AllocateFromChunk(size, alignment);
+		}
+
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		return AllocateFromChunk(size, alignment);
+	}
+
+	void FrameArena::Reset()
+	{
+		//a sub arena gets fresh chunks after its parent reset
+		if (m_pParent)
+		{
+			m_Current = m_End = 0;
+			return;
+		}
+
+		if (m_pBlocks.size() > 1)
+		{
+			const size_t capacity{ GetCapacity() };
+			for (std::byte* pBlock : m_pBlocks)
+			{
+				delete[] pBlock;
+			}
+			m_pBlocks.clear();
+			m_BlockSizes.clear();
+
+			m_BlockSize = std::max(m_BlockSize, capacity);
+		}
+
+		if (m_pBlocks.empty())
+		{
+			m_Current = m_End = 0;
+			return;
+		}
+
+		m_Current = reinterpret_cast<uintptr_t>(m_pBlocks[0]);
+		m_End = m_Current + m_BlockSizes[0];
+	}
+
+	size_t FrameArena::GetCapacity() const
+	{
+		return std::accumulate(m_BlockSizes.begin(), m_BlockSizes.end(), size_t{});
+	}
+
+	void* FrameArena::AllocateFromChunk(size_t size, size_t alignment)
+	{
+		const uintptr_t aligned{ (m_Current + alignment - 1) & ~(alignment - 1) };
+		if (m_Current != 0 && aligned + size <= m_End)
+		{
+			m_Current = aligned + size;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		return AllocateBlock(size, alignment);
+	}
+
+	void* FrameArena::AllocateBlock(size_t size, size_t alignment)
+	{
+		//big allocations get a chunk of their own, room for the alignment included
+		const size_t blockSize{ std::max(m_BlockSize, size + alignment) };
+
+		std::byte* pBlock{};
+		if (m_pParent)
+		{
+			pBlock = static_cast<std::byte*>(m_pParent->Allocate(blockSize, alignof(std::max_align_t)));
+		}
+		else
+		{
+			pBlock = new std::byte[blockSize];
+			m_pBlocks.push_back(pBlock);
+			m_BlockSizes.push_back(blockSize);
+		}
+
+		m_Current = reinterpret_cast<uintptr_t>(pBlock);
+		m_End = m_Current + blockSize;
+		return AllocateFromChunk(size, alignment);
+	}
+}
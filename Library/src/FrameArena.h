@@ -0,0 +1,85 @@
+#pragma once
+
+//Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dae
+{
+	//linear allocator for data that only lives for one frame
+	//allocating bumps a pointer, nothing is freed on its own => Reset drops every allocation at once
+	class FrameArena final
+	{
+	public:
+		//root arena, takes blocks of at least blockSize from the heap
+		explicit FrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+		//sub arena for a single thread, takes chunks of chunkSize from the parent => allocating doesn't lock
+		FrameArena(FrameArena& parent, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+		~FrameArena();
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) noexcept = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) noexcept = delete;
+
+		//a root arena can be shared by threads, a sub arena belongs to one thread at a time
+		void* Allocate(size_t size, size_t alignment);
+		//not thread safe, every allocation is gone afterwards
+		//a root arena that needed more than one block merges them => the next frame of the same size fits in one
+		void Reset();
+
+		//bytes of heap memory the arena holds on to
+		size_t GetCapacity() const;
+
+		static constexpr size_t DEFAULT_BLOCK_SIZE{ 1 << 20 };
+		static constexpr size_t DEFAULT_CHUNK_SIZE{ 1 << 16 };
+
+	private:
+		void* AllocateFromChunk(size_t size, size_t alignment);
+		void* AllocateBlock(size_t size, size_t alignment);
+
+		FrameArena* m_pParent{ nullptr };
+		size_t m_BlockSize{};
+
+		//chunk the next allocation comes from, the last block for a root arena
+		uintptr_t m_Current{};
+		uintptr_t m_End{};
+
+		//root only, the heap blocks & their sizes
+		std::vector<std::byte*> m_pBlocks{};
+		std::vector<size_t> m_BlockSizes{};
+		std::mutex m_Mutex{};
+	};
+
+	//STL allocator on top of a FrameArena, e.g. std::vector<Vertex_Out, FrameAllocator<Vertex_Out>>
+	//containers must be destroyed before the next Reset of the arena, assigning over them after it isn't enough
+	template<typename T>
+	class FrameAllocator
+	{
+	public:
+		using value_type = T;
+		//assigning a container takes the arena along, no element wise copies into another arena
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+		explicit FrameAllocator(FrameArena& arena) : m_pArena{ &arena } {}
+		template<typename U>
+		FrameAllocator(const FrameAllocator<U>& allocator) : m_pArena{ allocator.GetArena() } {}
+
+		T* allocate(size_t count) { return static_cast<T*>(m_pArena->Allocate(count * sizeof(T), alignof(T))); }
+		//the memory comes back when the arena resets
+		void deallocate(T*, size_t) {}
+
+		FrameArena* GetArena() const { return m_pArena; }
+
+		template<typename U>
+		bool operator==(const FrameAllocator<U>& allocator) const { return m_pArena == allocator.GetArena(); }
+
+	private:
+		FrameArena* m_pArena;
+	};
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& path)
+	{
+		m_FileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_FileHandle == INVALID_HANDLE_VALUE)
+		{
+			m_FileHandle = nullptr;
+			return;
+		}
+
+		LARGE_INTEGER size{};
+		//an empty file can't be mapped
+		if (!GetFileSizeEx(m_FileHandle, &size) || size.QuadPart == 0)
+		{
+			return;
+		}
+
+		m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_MappingHandle == nullptr)
+		{
+			return;
+		}
+
+		m_pData = static_cast<const std::byte*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		m_Size = m_pData ? static_cast<size_t>(size.QuadPart) : 0;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+		{
+			UnmapViewOfFile(m_pData);
+		}
+		if (m_MappingHandle)
+		{
+			CloseHandle(m_MappingHandle);
+		}
+		if (m_FileHandle)
+		{
+			CloseHandle(m_FileHandle);
+		}
+	}
+#else
+	MappedFile::MappedFile(const std::string& path)
+	{
+		const int fileDescriptor{ open(path.c_str(), O_RDONLY) };
+		if (fileDescriptor < 0)
+		{
+			return;
+		}
+
+		//an empty file can't be mapped
+		struct stat fileStatus{};
+		if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+		{
+			void* pData{ mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0) };
+			if (pData != MAP_FAILED)
+			{
+				m_pData = static_cast<const std::byte*>(pData);
+				m_Size = static_cast<size_t>(fileStatus.st_size);
+			}
+		}
+
+		//the mapping stays valid without the descriptor
+		close(fileDescriptor);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+		{
+			munmap(const_cast<std::byte*>(m_pData), m_Size);
+		}
+	}
+#endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+//Standard includes
+#include <cstddef>
+#include <string>
+
+namespace dae
+{
+	//read only view of a whole file, mapped by the OS instead of read into a buffer
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) noexcept = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+		bool IsOpen() const { return m_pData != nullptr; };
+		const std::byte* GetData() const { return m_pData; };
+		size_t GetSize() const { return m_Size; };
+
+	private:
+		const std::byte* m_pData{ nullptr };
+		size_t m_Size{};
+
+#ifdef _WIN32
+		void* m_FileHandle{ nullptr };
+		void* m_MappingHandle{ nullptr };
+#endif
+	};
+}
@@ -0,0 +1,316 @@
+#include "MaterialTexture.h"
+#include "Texture.h"
+#include "Vector2.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace dae
+{
+	MaterialTexture::MaterialTexture(int width, int height, TexelLayout layout, MaterialFormat format) :
+		m_MipLevels{ MipLevel{ width, height, 0, TexelAddressing{ width, height, layout, sizeof(MaterialTexel) } } },
+		m_Layout{ layout },
+		m_Format{ format },
+		m_Width{ width },
+		m_Height{ height }
+	{
+		m_Texels.resize(m_MipLevels[0].addressing.GetTexelCount());
+	}
+
+	MaterialTexture* MaterialTexture::LoadFromFiles(const std::string& diffusePath, const std::string& glossPath, const std::string& normalPath, const std::string& specularPath, TexelLayout layout, MaterialFormat format)
+	{
+		//the separate maps are only needed while interleaving
+		const std::unique_ptr<Texture> pDiffuse{ Texture::LoadFromFile(diffusePath) };
+		const std::unique_ptr<Texture> pGloss{ Texture::LoadFromFile(glossPath) };
+		const std::unique_ptr<Texture> pNormal{ Texture::LoadFromFile(normalPath) };
+		const std::unique_ptr<Texture> pSpecular{ Texture::LoadFromFile(specularPath) };
+
+		if (!pDiffuse || !pGloss || !pNormal || !pSpecular)
+		{
+			return nullptr;
+		}
+
+		MaterialTexture* pMaterial{ new MaterialTexture{ pDiffuse->GetWidth(), pDiffuse->GetHeight(), layout, format } };
+		for (int py{}; py < pMaterial->m_Height; ++py)
+		{
+			for (int px{}; px < pMaterial->m_Width; ++px)
+			{
+				//texel centers => maps of the same size copy over exactly
+				const Vector2 uv{ (px + 0.5f) / pMaterial->m_Width, (py + 0.5f) / pMaterial->m_Height };
+
+				MaterialTexel& texel{ pMaterial->m_Texels[pMaterial->m_MipLevels[0].addressing.GetIndex(px, py)] };
+				texel.diffuseGloss = (pDiffuse->SampleTexel(uv) & 0x00FFFFFF) | (pGloss->SampleTexel(uv) << 24);
+				texel.normal = pNormal->SampleTexel(uv);
+				texel.specular = pSpecular->SampleTexel(uv);
+			}
+		}
+
+		//the mip levels are filtered from the uncompressed texels, compressing comes last
+		pMaterial->GenerateMipLevels();
+		if (format != MaterialFormat::Uncompressed)
+		{
+			pMaterial->Compress();
+		}
+		return pMaterial;
+	}
+
+	void MaterialTexture::GenerateMipLevels()
+	{
+		//average of 4 packed texels, byte by byte
+		const auto average{ [](uint32_t texel0, uint32_t texel1, uint32_t texel2, uint32_t texel3)
+			{
+				uint32_t result{};
+				for (int shift{}; shift < 32; shift += 8)
+				{
+					const uint32_t sum{ ((texel0 >> shift) & 0xFF) + ((texel1 >> shift) & 0xFF) + ((texel2 >> shift) & 0xFF) + ((texel3 >> shift) & 0xFF) };
+					result |= ((sum + 2) / 4) << shift;
+				}
+				return result;
+			} };
+
+		while (m_MipLevels.back().width > 1 || m_MipLevels.back().height > 1)
+		{
+			const MipLevel source{ m_MipLevels.back() };
+			const int width{ std::max(source.width / 2, 1) };
+			const int height{ std::max(source.height / 2, 1) };
+			const MipLevel level{ width, height, m_Texels.size(), TexelAddressing{ width, height, m_Layout, sizeof(MaterialTexel) } };
+			m_Texels.resize(m_Texels.size() + level.addressing.GetTexelCount());
+			m_MipLevels.push_back(level);
+
+			for (int py{}; py < level.height; ++py)
+			{
+				//odd sizes => the last row/column gets reused
+				const int sourceY0{ std::min(py * 2, source.height - 1) };
+				const int sourceY1{ std::min(py * 2 + 1, source.height - 1) };
+
+				for (int px{}; px < level.width; ++px)
+				{
+					const int sourceX0{ std::min(px * 2, source.width - 1) };
+					const int sourceX1{ std::min(px * 2 + 1, source.width - 1) };
+
+					//copies, resizing m_Texels would leave references dangling
+					const MaterialTexel texel0{ source.GetTexel(m_Texels, sourceX0, sourceY0) };
+					const MaterialTexel texel1{ source.GetTexel(m_Texels, sourceX1, sourceY0) };
+					const MaterialTexel texel2{ source.GetTexel(m_Texels, sourceX0, sourceY1) };
+					const MaterialTexel texel3{ source.GetTexel(m_Texels, sourceX1, sourceY1) };
+
+					MaterialTexel& texel{ m_Texels[level.firstTexelIdx + level.addressing.GetIndex(px, py)] };
+					texel.diffuseGloss = average(texel0.diffuseGloss, texel1.diffuseGloss, texel2.diffuseGloss, texel3.diffuseGloss);
+					texel.normal = average(texel0.normal, texel1.normal, texel2.normal, texel3.normal);
+					texel.specular = average(texel0.specular, texel1.specular, texel2.specular, texel3.specular);
+				}
+			}
+		}
+	}
+
+	void MaterialTexture::Compress()
+	{
+		for (MipLevel& level : m_MipLevels)
+		{
+			const int blockCountX{ (level.width + 3) / 4 };
+			const int blockCountY{ (level.height + 3) / 4 };
+			level.firstBlockIdx = m_Blocks.size();
+			level.blockAddressing = TexelAddressing{ blockCountX, blockCountY, m_Layout, sizeof(MaterialBlock) };
+			m_Blocks.resize(m_Blocks.size() + level.blockAddressing.GetTexelCount());
+
+			for (int blockY{}; blockY < blockCountY; ++blockY)
+			{
+				for (int blockX{}; blockX < blockCountX; ++blockX)
+				{
+					//levels smaller than a block repeat their last row/column
+					uint32_t diffuseGloss[16]{};
+					uint32_t specular[16]{};
+					for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+					{
+						const int x{ std::min(blockX * 4 + (texelIdx & 3), level.width - 1) };
+						const int y{ std::min(blockY * 4 + (texelIdx >> 2), level.height - 1) };
+						const MaterialTexel& texel{ level.GetTexel(m_Texels, x, y) };
+						diffuseGloss[texelIdx] = texel.diffuseGloss;
+						specular[texelIdx] = texel.specular;
+					}
+
+					MaterialBlock& block{ m_Blocks[level.firstBlockIdx + level.blockAddressing.GetIndex(blockX, blockY)] };
+					block.diffuseGloss = EncodeBc3(diffuseGloss);
+					block.specular = EncodeBc1(specular);
+				}
+			}
+		}
+
+		//the normals get tiles & padding of their own, the ones of the 24 byte blocks are too small for them
+		for (MipLevel& level : m_MipLevels)
+		{
+			if (m_Format == MaterialFormat::Compressed)
+			{
+				const int blockCountX{ (level.width + 3) / 4 };
+				const int blockCountY{ (level.height + 3) / 4 };
+				level.firstNormalIdx = m_NormalBlocks.size();
+				level.normalAddressing = TexelAddressing{ blockCountX, blockCountY, m_Layout, sizeof(Bc1Block) };
+				m_NormalBlocks.resize(m_NormalBlocks.size() + level.normalAddressing.GetTexelCount());
+
+				for (int blockY{}; blockY < blockCountY; ++blockY)
+				{
+					for (int blockX{}; blockX < blockCountX; ++blockX)
+					{
+						uint32_t normal[16]{};
+						for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+						{
+							const int x{ std::min(blockX * 4 + (texelIdx & 3), level.width - 1) };
+							const int y{ std::min(blockY * 4 + (texelIdx >> 2), level.height - 1) };
+							normal[texelIdx] = level.GetTexel(m_Texels, x, y).normal;
+						}
+						m_NormalBlocks[level.firstNormalIdx + level.normalAddressing.GetIndex(blockX, blockY)] = EncodeBc1(normal);
+					}
+				}
+			}
+			else
+			{
+				level.firstNormalIdx = m_Normals.size();
+				level.normalAddressing = TexelAddressing{ level.width, level.height, m_Layout, sizeof(uint32_t) };
+				m_Normals.resize(m_Normals.size() + level.normalAddressing.GetTexelCount());
+
+				for (int py{}; py < level.height; ++py)
+				{
+					for (int px{}; px < level.width; ++px)
+					{
+						m_Normals[level.firstNormalIdx + level.normalAddressing.GetIndex(px, py)] = level.GetTexel(m_Texels, px, py).normal;
+					}
+				}
+			}
+		}
+
+		//swap => the memory is actually released
+		std::vector<MaterialTexel>{}.swap(m_Texels);
+	}
+
+	void MaterialTexture::AccumulateTexel(const MipLevel& level, int x, int y, float weight, uint8_t maps, float channels[10]) const
+	{
+		//bytes of a packed texel, weighted
+		const auto accumulateBytes{ [weight](uint32_t texel, int channelCount, float* pChannels)
+			{
+				for (int channelIdx{}; channelIdx < channelCount; ++channelIdx)
+				{
+					pChannels[channelIdx] += ((texel >> (channelIdx * 8)) & 0xFF) * weight;
+				}
+			} };
+
+		if (m_Format == MaterialFormat::Uncompressed)
+		{
+			const MaterialTexel& texel{ level.GetTexel(m_Texels, x, y) };
+			if (maps & diffuseMap)
+			{
+				accumulateBytes(texel.diffuseGloss, 3, channels);
+			}
+			if (maps & glossMap)
+			{
+				channels[3] += (texel.diffuseGloss >> 24) * weight;
+			}
+			if (maps & normalMap)
+			{
+				accumulateBytes(texel.normal, 3, channels + 4);
+			}
+			if (maps & specularMap)
+			{
+				accumulateBytes(texel.specular, 3, channels + 7);
+			}
+			return;
+		}
+
+		const MaterialBlock& block{ m_Blocks[level.firstBlockIdx + level.blockAddressing.GetIndex(x >> 2, y >> 2)] };
+		const int texelIdx{ (x & 3) + ((y & 3) << 2) };
+
+		if (maps & diffuseMap)
+		{
+			AccumulateBc1(block.diffuseGloss.color, texelIdx, weight, channels);
+		}
+		if (maps & glossMap)
+		{
+			AccumulateBc3Alpha(block.diffuseGloss, texelIdx, weight, channels[3]);
+		}
+		if (maps & normalMap)
+		{
+			if (m_Format == MaterialFormat::Compressed)
+			{
+				AccumulateBc1(m_NormalBlocks[level.firstNormalIdx + level.normalAddressing.GetIndex(x >> 2, y >> 2)], texelIdx, weight, channels + 4);
+			}
+			else
+			{
+				accumulateBytes(m_Normals[level.firstNormalIdx + level.normalAddressing.GetIndex(x, y)], 3, channels + 4);
+			}
+		}
+		if (maps & specularMap)
+		{
+			AccumulateBc1(block.specular, texelIdx, weight, channels + 7);
+		}
+	}
+
+	size_t MaterialTexture::GetMemorySize() const
+	{
+		return m_Texels.size() * sizeof(MaterialTexel) + m_Blocks.size() * sizeof(MaterialBlock) + m_NormalBlocks.size() * sizeof(Bc1Block) + m_Normals.size() * sizeof(uint32_t);
+	}
+
+	float MaterialTexture::GetMipLevel(const Vector2& uvDerivativeX, const Vector2& uvDerivativeY) const
+	{
+		//footprint of a pixel in texels of level 0, the longest side picks the level
+		const Vector2 texelDerivativeX{ uvDerivativeX.x * m_Width, uvDerivativeX.y * m_Height };
+		const Vector2 texelDerivativeY{ uvDerivativeY.x * m_Width, uvDerivativeY.y * m_Height };
+		const float footprintSquared{ std::max(texelDerivativeX.SqrMagnitude(), texelDerivativeY.SqrMagnitude()) };
+
+		//log2(sqrt(x)) = log2(x) / 2, magnification (and NaN) stays on level 0
+		const float mipLevel{ 0.5f * std::log2(footprintSquared) };
+		if (!(mipLevel > 0.f))
+		{
+			return 0.f;
+		}
+		return std::min(mipLevel, static_cast<float>(m_MipLevels.size() - 1));
+	}
+
+	MaterialSample MaterialTexture::Sample(const Vector2& uv, float mipLevel, uint8_t maps) const
+	{
+		//blend the 2 levels around mipLevel, skip the second one when it barely counts
+		const int levelIdx{ static_cast<int>(mipLevel) };
+		const float levelWeight{ mipLevel - levelIdx };
+
+		float channels[10]{};
+		if (levelWeight < 1.f / 256.f || levelIdx + 1 >= static_cast<int>(m_MipLevels.size()))
+		{
+			SampleLevel(uv, levelIdx, 1.f, maps, channels);
+		}
+		else
+		{
+			SampleLevel(uv, levelIdx, 1.f - levelWeight, maps, channels);
+			SampleLevel(uv, levelIdx + 1, levelWeight, maps, channels);
+		}
+
+		MaterialSample sample{};
+		sample.diffuse = ColorRGB{ channels[0], channels[1], channels[2] };
+		sample.gloss = channels[3];
+		sample.normal = ColorRGB{ channels[4], channels[5], channels[6] };
+		sample.specular = ColorRGB{ channels[7], channels[8], channels[9] };
+		return sample;
+	}
+
+	void MaterialTexture::SampleLevel(const Vector2& uv, int levelIdx, float weight, uint8_t maps, float channels[10]) const
+	{
+		const MipLevel& level{ m_MipLevels[levelIdx] };
+
+		//texel centers sit at +0.5, clamp to the edge
+		const float texelX{ std::clamp(uv.x, 0.f, 1.f) * level.width - 0.5f };
+		const float texelY{ std::clamp(uv.y, 0.f, 1.f) * level.height - 0.5f };
+		const float floorX{ std::floor(texelX) };
+		const float floorY{ std::floor(texelY) };
+		const float fractionX{ texelX - floorX };
+		const float fractionY{ texelY - floorY };
+
+		const int x0{ std::max(static_cast<int>(floorX), 0) };
+		const int y0{ std::max(static_cast<int>(floorY), 0) };
+		const int x1{ std::min(static_cast<int>(floorX) + 1, level.width - 1) };
+		const int y1{ std::min(static_cast<int>(floorY) + 1, level.height - 1) };
+
+		//weights also turn bytes into [0, 1]
+		constexpr float toFloat{ 1.f / 255.f };
+		AccumulateTexel(level, x0, y0, (1.f - fractionX) * (1.f - fractionY) * weight * toFloat, maps, channels);
+		AccumulateTexel(level, x1, y0, fractionX * (1.f - fractionY) * weight * toFloat, maps, channels);
+		AccumulateTexel(level, x0, y1, (1.f - fractionX) * fractionY * weight * toFloat, maps, channels);
+		AccumulateTexel(level, x1, y1, fractionX * fractionY * weight * toFloat, maps, channels);
+	}
+}
\ No newline at end of file
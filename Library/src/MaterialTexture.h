@@ -0,0 +1,123 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "BlockCompression.h"
+#include "ColorRGB.h"
+#include "TexelLayout.h"
+
+namespace dae
+{
+	struct Vector2;
+
+	//everything PixelShading reads from the maps of a material at one uv
+	struct MaterialSample
+	{
+		ColorRGB diffuse{};
+		//only the red channel of the gloss map is used
+		float gloss{};
+		ColorRGB normal{};
+		ColorRGB specular{};
+	};
+
+	//maps of a material a Sample reads, the channels of the others stay 0
+	enum MaterialMap : uint8_t
+	{
+		diffuseMap = 1 << 0,
+		glossMap = 1 << 1,
+		normalMap = 1 << 2,
+		specularMap = 1 << 3,
+		allMaps = diffuseMap | glossMap | normalMap | specularMap
+	};
+
+	//how the maps of a material are kept in memory
+	enum class MaterialFormat
+	{
+		//16 bytes per texel
+		Uncompressed,
+		//diffuse & gloss as BC3, normal & specular as BC1 => 2 bytes per texel
+		Compressed,
+		//BC1 bands the normals, they stay 4 bytes per texel => 5.5 bytes per texel
+		CompressedLosslessNormals
+	};
+
+	//diffuse, gloss, normal & specular map interleaved per texel
+	//they're always sampled at the same uv => one fetch hits one cache line instead of four arrays
+	class MaterialTexture final
+	{
+	public:
+		~MaterialTexture() = default;
+
+		MaterialTexture(const MaterialTexture&) = delete;
+		MaterialTexture(MaterialTexture&&) noexcept = delete;
+		MaterialTexture& operator=(const MaterialTexture&) = delete;
+		MaterialTexture& operator=(MaterialTexture&&) noexcept = delete;
+
+		//the maps are resampled to the size of the diffuse map when they differ, the mip chain is built & compressed right after
+		static MaterialTexture* LoadFromFiles(const std::string& diffusePath, const std::string& glossPath, const std::string& normalPath, const std::string& specularPath, TexelLayout layout = TexelLayout::Linear, MaterialFormat format = MaterialFormat::Uncompressed);
+
+		//level of detail from the change of uv to the next pixel on the right & below
+		float GetMipLevel(const Vector2& uvDerivativeX, const Vector2& uvDerivativeY) const;
+		//trilinear, uv is clamped to [0, 1]
+		MaterialSample Sample(const Vector2& uv, float mipLevel = 0.f, uint8_t maps = allMaps) const;
+
+		//bytes the whole mip chain takes up
+		size_t GetMemorySize() const;
+
+	private:
+		//0xAABBGGRR like Texture, the alpha of the diffuse texel holds the gloss
+		//16 bytes => 4 texels per cache line and none of them straddles two
+		struct alignas(16) MaterialTexel
+		{
+			uint32_t diffuseGloss{};
+			uint32_t normal{};
+			uint32_t specular{};
+		};
+
+		//the 4x4 texels of the maps that are always compressed, the normals live on their own
+		//24 bytes => no room wasted on a normal block lossless normals don't use
+		struct MaterialBlock
+		{
+			Bc3Block diffuseGloss{};
+			Bc1Block specular{};
+		};
+
+		//every level of the chain lives in m_Texels (or m_Blocks & the normals) after the previous one
+		struct MipLevel
+		{
+			int width{};
+			int height{};
+			size_t firstTexelIdx{};
+			TexelAddressing addressing{};
+			size_t firstBlockIdx{};
+			//addresses 4x4 blocks
+			TexelAddressing blockAddressing{};
+			size_t firstNormalIdx{};
+			//addresses m_Normals, or m_NormalBlocks per 4x4 block when the normals are compressed
+			TexelAddressing normalAddressing{};
+
+			const MaterialTexel& GetTexel(const std::vector<MaterialTexel>& texels, int x, int y) const { return texels[firstTexelIdx + addressing.GetIndex(x, y)]; };
+		};
+
+		MaterialTexture(int width, int height, TexelLayout layout, MaterialFormat format);
+
+		//each level halves the previous one with a 2x2 box filter, down to 1x1
+		void GenerateMipLevels();
+		//encodes every level in m_Blocks & the normals & frees m_Texels
+		void Compress();
+		//adds the texel with weight into the 10 channels of a sample, decodes it when compressed
+		void AccumulateTexel(const MipLevel& level, int x, int y, float weight, uint8_t maps, float channels[10]) const;
+		//bilinear, adds the texels of one level with weight into the 10 channels of a sample
+		void SampleLevel(const Vector2& uv, int levelIdx, float weight, uint8_t maps, float channels[10]) const;
+
+		std::vector<MaterialTexel> m_Texels{};
+		std::vector<MaterialBlock> m_Blocks{};
+		//the normals, every level after the previous one like m_Texels
+		std::vector<Bc1Block> m_NormalBlocks{};
+		std::vector<uint32_t> m_Normals{};
+		std::vector<MipLevel> m_MipLevels{};
+		TexelLayout m_Layout{};
+		MaterialFormat m_Format{};
+		int m_Width{};
+		int m_Height{};
+	};
+}
@@ -0,0 +1,404 @@
+#pragma once
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <immintrin.h>
+
+namespace dae
+{
+	namespace Simd
+	{
+		//Every float type below holds one value per lane and has the same interface,
+		//so a kernel written as template<typename Float> runs on any of them.
+		//The lanes cover a block of Width / 2 pixels wide and 2 pixels high, row by row:
+		//lane = x + (y * Width / 2)
+		//Comparisons return masks, lanes that are all bits set (true) or all zero (false).
+
+		//where the 8 bit channels of a 32 bit pixel are, resolved once from the surface format
+		struct PixelFormat
+		{
+			int redShift{ 16 };
+			int greenShift{ 8 };
+			int blueShift{ 0 };
+			//alpha bits are always set => opaque
+			uint32_t alphaMask{};
+		};
+
+		/* --- SCALAR FALLBACK --- */
+		struct ScalarFloat4
+		{
+			static constexpr int Width{ 4 };
+			static constexpr int BlockWidth{ Width / 2 };
+
+			float v[Width]{};
+
+			ScalarFloat4() = default;
+			ScalarFloat4(float s) : v{ s, s, s, s } {}
+
+			static ScalarFloat4 Load(const float* p) { return { p[0], p[1], p[2], p[3] }; }
+			static ScalarFloat4 LoadRows(const float* pRow0, const float* pRow1) { return { pRow0[0], pRow0[1], pRow1[0], pRow1[1] }; }
+			static ScalarFloat4 LaneX() { return { 0.f, 1.f, 0.f, 1.f }; }
+			static ScalarFloat4 LaneY() { return { 0.f, 0.f, 1.f, 1.f }; }
+
+			void Store(float* p) const { for (int i{}; i < Width; ++i) p[i] = v[i]; }
+			void StoreRows(float* pRow0, float* pRow1) const { pRow0[0] = v[0]; pRow0[1] = v[1]; pRow1[0] = v[2]; pRow1[1] = v[3]; }
+
+			//bit i is set when lane i of the mask is true
+			int MoveMask() const
+			{
+				int mask{};
+				for (int i{}; i < Width; ++i) mask |= static_cast<int>(std::bit_cast<uint32_t>(v[i]) >> 31) << i;
+				return mask;
+			}
+
+			#pragma region ScalarFloat4 Operators
+			ScalarFloat4 operator+(const ScalarFloat4& f) const { return Apply(f, [](float a, float b) { return a + b; }); }
+			ScalarFloat4 operator-(const ScalarFloat4& f) const { return Apply(f, [](float a, float b) { return a - b; }); }
+			ScalarFloat4 operator*(const ScalarFloat4& f) const { return Apply(f, [](float a, float b) { return a * b; }); }
+			ScalarFloat4 operator/(const ScalarFloat4& f) const { return Apply(f, [](float a, float b) { return a / b; }); }
+			ScalarFloat4 operator-() const { return ScalarFloat4{ 0.f } - *this; }
+			ScalarFloat4& operator+=(const ScalarFloat4& f) { return *this = *this + f; }
+			ScalarFloat4& operator*=(const ScalarFloat4& f) { return *this = *this * f; }
+
+			ScalarFloat4 operator<(const ScalarFloat4& f) const { return Compare(f, [](float a, float b) { return a < b; }); }
+			ScalarFloat4 operator<=(const ScalarFloat4& f) const { return Compare(f, [](float a, float b) { return a <= b; }); }
+			ScalarFloat4 operator>(const ScalarFloat4& f) const { return Compare(f, [](float a, float b) { return a > b; }); }
+			ScalarFloat4 operator>=(const ScalarFloat4& f) const { return Compare(f, [](float a, float b) { return a >= b; }); }
+			ScalarFloat4 operator==(const ScalarFloat4& f) const { return Compare(f, [](float a, float b) { return a == b; }); }
+
+			ScalarFloat4 operator&(const ScalarFloat4& f) const { return Bits(f, [](uint32_t a, uint32_t b) { return a & b; }); }
+			ScalarFloat4 operator|(const ScalarFloat4& f) const { return Bits(f, [](uint32_t a, uint32_t b) { return a | b; }); }
+			#pragma endregion
+
+			friend ScalarFloat4 Min(const ScalarFloat4& a, const ScalarFloat4& b) { return a.Apply(b, [](float x, float y) { return y < x ? y : x; }); }
+			friend ScalarFloat4 Max(const ScalarFloat4& a, const ScalarFloat4& b) { return a.Apply(b, [](float x, float y) { return x < y ? y : x; }); }
+			friend ScalarFloat4 Sqrt(const ScalarFloat4& a) { return a.Apply(a, [](float x, float) { return std::sqrt(x); }); }
+			friend ScalarFloat4 Abs(const ScalarFloat4& a) { return a.Apply(a, [](float x, float) { return std::abs(x); }); }
+			friend ScalarFloat4 Pow(const ScalarFloat4& a, const ScalarFloat4& b) { return a.Apply(b, [](float x, float y) { return std::pow(x, y); }); }
+
+			//[-1, 1] to 16 bit snorms rounded like std::round, x in the low & y in the high half of the bits of a lane, NaN => -1
+			friend ScalarFloat4 PackSnorm16(const ScalarFloat4& x, const ScalarFloat4& y)
+			{
+				const auto toSnorm{ [](float value) { return static_cast<uint32_t>(static_cast<uint16_t>(static_cast<int16_t>(std::round((value > -1.f ? (value < 1.f ? value : 1.f) : -1.f) * 32767.f)))); } };
+				return x.Bits(y, [&toSnorm](uint32_t a, uint32_t b) { return toSnorm(std::bit_cast<float>(a)) | (toSnorm(std::bit_cast<float>(b)) << 16); });
+			}
+
+			//[0, 1] channels to one 32 bit pixel per lane, truncated to 8 bits like static_cast<uint8_t>(channel * 255) & NaN => 0
+			friend void StorePixels(const ScalarFloat4& r, const ScalarFloat4& g, const ScalarFloat4& b, const PixelFormat& format, uint32_t* pPixels)
+			{
+				const auto toByte{ [](float channel) { return static_cast<uint32_t>(channel > 0.f ? (channel < 1.f ? channel * 255.f : 255.f) : 0.f); } };
+				for (int i{}; i < Width; ++i)
+				{
+					pPixels[i] = (toByte(r.v[i]) << format.redShift) | (toByte(g.v[i]) << format.greenShift) | (toByte(b.v[i]) << format.blueShift) | format.alphaMask;
+				}
+			}
+
+			//mask ? a : b, per lane
+			friend ScalarFloat4 Select(const ScalarFloat4& mask, const ScalarFloat4& a, const ScalarFloat4& b)
+			{
+				ScalarFloat4 result{};
+				for (int i{}; i < Width; ++i) result.v[i] = std::bit_cast<uint32_t>(mask.v[i]) ? a.v[i] : b.v[i];
+				return result;
+			}
+
+		private:
+			ScalarFloat4(float a, float b, float c, float d) : v{ a, b, c, d } {}
+
+			template<typename Operation>
+			ScalarFloat4 Apply(const ScalarFloat4& f, Operation operation) const
+			{
+				ScalarFloat4 result{};
+				for (int i{}; i < Width; ++i) result.v[i] = operation(v[i], f.v[i]);
+				return result;
+			}
+
+			template<typename Operation>
+			ScalarFloat4 Compare(const ScalarFloat4& f, Operation operation) const
+			{
+				ScalarFloat4 result{};
+				for (int i{}; i < Width; ++i) result.v[i] = std::bit_cast<float>(operation(v[i], f.v[i]) ? 0xFFFFFFFFu : 0u);
+				return result;
+			}
+
+			template<typename Operation>
+			ScalarFloat4 Bits(const ScalarFloat4& f, Operation operation) const
+			{
+				ScalarFloat4 result{};
+				for (int i{}; i < Width; ++i) result.v[i] = std::bit_cast<float>(operation(std::bit_cast<uint32_t>(v[i]), std::bit_cast<uint32_t>(f.v[i])));
+				return result;
+			}
+		};
+
+		/* --- SSE --- */
+		struct SseFloat4
+		{
+			static constexpr int Width{ 4 };
+			static constexpr int BlockWidth{ Width / 2 };
+
+			__m128 v{ _mm_setzero_ps() };
+
+			SseFloat4() = default;
+			SseFloat4(float s) : v{ _mm_set1_ps(s) } {}
+			SseFloat4(__m128 _v) : v{ _v } {}
+
+			static SseFloat4 Load(const float* p) { return _mm_loadu_ps(p); }
+			static SseFloat4 LoadRows(const float* pRow0, const float* pRow1)
+			{
+				const __m128 row0{ _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(pRow0))) };
+				return _mm_loadh_pi(row0, reinterpret_cast<const __m64*>(pRow1));
+			}
+			static SseFloat4 LaneX() { return _mm_setr_ps(0.f, 1.f, 0.f, 1.f); }
+			static SseFloat4 LaneY() { return _mm_setr_ps(0.f, 0.f, 1.f, 1.f); }
+
+			void Store(float* p) const { _mm_storeu_ps(p, v); }
+			void StoreRows(float* pRow0, float* pRow1) const
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(pRow0), v);
+				_mm_storeh_pi(reinterpret_cast<__m64*>(pRow1), v);
+			}
+
+			int MoveMask() const { return _mm_movemask_ps(v); }
+
+			#pragma region SseFloat4 Operators
+			SseFloat4 operator+(const SseFloat4& f) const { return _mm_add_ps(v, f.v); }
+			SseFloat4 operator-(const SseFloat4& f) const { return _mm_sub_ps(v, f.v); }
+			SseFloat4 operator*(const SseFloat4& f) const { return _mm_mul_ps(v, f.v); }
+			SseFloat4 operator/(const SseFloat4& f) const { return _mm_div_ps(v, f.v); }
+			SseFloat4 operator-() const { return _mm_xor_ps(v, _mm_set1_ps(-0.f)); }
+			SseFloat4& operator+=(const SseFloat4& f) { v = _mm_add_ps(v, f.v); return *this; }
+			SseFloat4& operator*=(const SseFloat4& f) { v = _mm_mul_ps(v, f.v); return *this; }
+
+			SseFloat4 operator<(const SseFloat4& f) const { return _mm_cmplt_ps(v, f.v); }
+			SseFloat4 operator<=(const SseFloat4& f) const { return _mm_cmple_ps(v, f.v); }
+			SseFloat4 operator>(const SseFloat4& f) const { return _mm_cmpgt_ps(v, f.v); }
+			SseFloat4 operator>=(const SseFloat4& f) const { return _mm_cmpge_ps(v, f.v); }
+			SseFloat4 operator==(const SseFloat4& f) const { return _mm_cmpeq_ps(v, f.v); }
+
+			SseFloat4 operator&(const SseFloat4& f) const { return _mm_and_ps(v, f.v); }
+			SseFloat4 operator|(const SseFloat4& f) const { return _mm_or_ps(v, f.v); }
+			#pragma endregion
+
+			friend SseFloat4 Min(const SseFloat4& a, const SseFloat4& b) { return _mm_min_ps(a.v, b.v); }
+			friend SseFloat4 Max(const SseFloat4& a, const SseFloat4& b) { return _mm_max_ps(a.v, b.v); }
+			friend SseFloat4 Sqrt(const SseFloat4& a) { return _mm_sqrt_ps(a.v); }
+			friend SseFloat4 Abs(const SseFloat4& a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+			friend SseFloat4 Select(const SseFloat4& mask, const SseFloat4& a, const SseFloat4& b)
+			{
+				return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+			}
+
+			//log2 & exp2 approximations, relative error ~1e-5 which is plenty for 8 bit colour
+			friend SseFloat4 Log2(const SseFloat4& a)
+			{
+				const __m128i bits{ _mm_castps_si128(a.v) };
+				const __m128i exponent{ _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)) };
+				const SseFloat4 mantissa{ _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000))) };
+				return Log2Polynomial(mantissa) * (mantissa - 1.f) + SseFloat4{ _mm_cvtepi32_ps(exponent) };
+			}
+			friend SseFloat4 Exp2(const SseFloat4& a)
+			{
+				const SseFloat4 x{ Min(Max(a, -126.99999f), 129.f) };
+				const __m128i integerPart{ _mm_cvtps_epi32((x - 0.5f).v) };
+				const SseFloat4 fractionPart{ x - SseFloat4{ _mm_cvtepi32_ps(integerPart) } };
+				const SseFloat4 integerPow{ _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(integerPart, _mm_set1_epi32(127)), 23)) };
+				return integerPow * Exp2Polynomial(fractionPart);
+			}
+			friend SseFloat4 Pow(const SseFloat4& a, const SseFloat4& b) { return Exp2(Log2(a) * b); }
+
+			//like the scalar PackSnorm16, half away from zero is truncating value + sign(value) * 0.5
+			friend SseFloat4 PackSnorm16(const SseFloat4& x, const SseFloat4& y)
+			{
+				const auto toSnorm{ [](const SseFloat4& value)
+					{
+						const __m128 scaled{ _mm_mul_ps(_mm_min_ps(_mm_max_ps(value.v, _mm_set1_ps(-1.f)), _mm_set1_ps(1.f)), _mm_set1_ps(32767.f)) };
+						const __m128 half{ _mm_or_ps(_mm_and_ps(scaled, _mm_set1_ps(-0.f)), _mm_set1_ps(0.5f)) };
+						return _mm_cvttps_epi32(_mm_add_ps(scaled, half));
+					} };
+				return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(toSnorm(x), _mm_set1_epi32(0xFFFF)), _mm_slli_epi32(toSnorm(y), 16)));
+			}
+
+			//like the scalar StorePixels, max(NaN, 0) is 0
+			friend void StorePixels(const SseFloat4& r, const SseFloat4& g, const SseFloat4& b, const PixelFormat& format, uint32_t* pPixels)
+			{
+				const auto toByte{ [](const SseFloat4& channel) { return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(channel.v, _mm_set1_ps(255.f)), _mm_setzero_ps()), _mm_set1_ps(255.f))); } };
+				const __m128i red{ _mm_sll_epi32(toByte(r), _mm_cvtsi32_si128(format.redShift)) };
+				const __m128i green{ _mm_sll_epi32(toByte(g), _mm_cvtsi32_si128(format.greenShift)) };
+				const __m128i blue{ _mm_sll_epi32(toByte(b), _mm_cvtsi32_si128(format.blueShift)) };
+				const __m128i alpha{ _mm_set1_epi32(static_cast<int>(format.alphaMask)) };
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels), _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, alpha)));
+			}
+
+		private:
+			static SseFloat4 Log2Polynomial(const SseFloat4& m);
+			static SseFloat4 Exp2Polynomial(const SseFloat4& f);
+		};
+
+		/* --- AVX2 --- */
+		struct AvxFloat8
+		{
+			static constexpr int Width{ 8 };
+			static constexpr int BlockWidth{ Width / 2 };
+
+			__m256 v{ _mm256_setzero_ps() };
+
+			AvxFloat8() = default;
+			AvxFloat8(float s) : v{ _mm256_set1_ps(s) } {}
+			AvxFloat8(__m256 _v) : v{ _v } {}
+
+			static AvxFloat8 Load(const float* p) { return _mm256_loadu_ps(p); }
+			static AvxFloat8 LoadRows(const float* pRow0, const float* pRow1) { return _mm256_loadu2_m128(pRow1, pRow0); }
+			static AvxFloat8 LaneX() { return _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 0.f, 1.f, 2.f, 3.f); }
+			static AvxFloat8 LaneY() { return _mm256_setr_ps(0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f); }
+
+			void Store(float* p) const { _mm256_storeu_ps(p, v); }
+			void StoreRows(float* pRow0, float* pRow1) const { _mm256_storeu2_m128(pRow1, pRow0, v); }
+
+			int MoveMask() const { return _mm256_movemask_ps(v); }
+
+			#pragma region AvxFloat8 Operators
+			AvxFloat8 operator+(const AvxFloat8& f) const { return _mm256_add_ps(v, f.v); }
+			AvxFloat8 operator-(const AvxFloat8& f) const { return _mm256_sub_ps(v, f.v); }
+			AvxFloat8 operator*(const AvxFloat8& f) const { return _mm256_mul_ps(v, f.v); }
+			AvxFloat8 operator/(const AvxFloat8& f) const { return _mm256_div_ps(v, f.v); }
+			AvxFloat8 operator-() const { return _mm256_xor_ps(v, _mm256_set1_ps(-0.f)); }
+			AvxFloat8& operator+=(const AvxFloat8& f) { v = _mm256_add_ps(v, f.v); return *this; }
+			AvxFloat8& operator*=(const AvxFloat8& f) { v = _mm256_mul_ps(v, f.v); return *this; }
+
+			AvxFloat8 operator<(const AvxFloat8& f) const { return _mm256_cmp_ps(v, f.v, _CMP_LT_OQ); }
+			AvxFloat8 operator<=(const AvxFloat8& f) const { return _mm256_cmp_ps(v, f.v, _CMP_LE_OQ); }
+			AvxFloat8 operator>(const AvxFloat8& f) const { return _mm256_cmp_ps(v, f.v, _CMP_GT_OQ); }
+			AvxFloat8 operator>=(const AvxFloat8& f) const { return _mm256_cmp_ps(v, f.v, _CMP_GE_OQ); }
+			AvxFloat8 operator==(const AvxFloat8& f) const { return _mm256_cmp_ps(v, f.v, _CMP_EQ_OQ); }
+
+			AvxFloat8 operator&(const AvxFloat8& f) const { return _mm256_and_ps(v, f.v); }
+			AvxFloat8 operator|(const AvxFloat8& f) const { return _mm256_or_ps(v, f.v); }
+			#pragma endregion
+
+			friend AvxFloat8 Min(const AvxFloat8& a, const AvxFloat8& b) { return _mm256_min_ps(a.v, b.v); }
+			friend AvxFloat8 Max(const AvxFloat8& a, const AvxFloat8& b) { return _mm256_max_ps(a.v, b.v); }
+			friend AvxFloat8 Sqrt(const AvxFloat8& a) { return _mm256_sqrt_ps(a.v); }
+			friend AvxFloat8 Abs(const AvxFloat8& a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+			friend AvxFloat8 Select(const AvxFloat8& mask, const AvxFloat8& a, const AvxFloat8& b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+
+			friend AvxFloat8 Log2(const AvxFloat8& a)
+			{
+				const __m256i bits{ _mm256_castps_si256(a.v) };
+				const __m256i exponent{ _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)) };
+				const AvxFloat8 mantissa{ _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000))) };
+				return Log2Polynomial(mantissa) * (mantissa - 1.f) + AvxFloat8{ _mm256_cvtepi32_ps(exponent) };
+			}
+			friend AvxFloat8 Exp2(const AvxFloat8& a)
+			{
+				const AvxFloat8 x{ Min(Max(a, -126.99999f), 129.f) };
+				const __m256i integerPart{ _mm256_cvtps_epi32((x - 0.5f).v) };
+				const AvxFloat8 fractionPart{ x - AvxFloat8{ _mm256_cvtepi32_ps(integerPart) } };
+				const AvxFloat8 integerPow{ _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(integerPart, _mm256_set1_epi32(127)), 23)) };
+				return integerPow * Exp2Polynomial(fractionPart);
+			}
+			friend AvxFloat8 Pow(const AvxFloat8& a, const AvxFloat8& b) { return Exp2(Log2(a) * b); }
+
+			friend AvxFloat8 PackSnorm16(const AvxFloat8& x, const AvxFloat8& y)
+			{
+				const auto toSnorm{ [](const AvxFloat8& value)
+					{
+						const __m256 scaled{ _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(value.v, _mm256_set1_ps(-1.f)), _mm256_set1_ps(1.f)), _mm256_set1_ps(32767.f)) };
+						const __m256 half{ _mm256_or_ps(_mm256_and_ps(scaled, _mm256_set1_ps(-0.f)), _mm256_set1_ps(0.5f)) };
+						return _mm256_cvttps_epi32(_mm256_add_ps(scaled, half));
+					} };
+				return _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(toSnorm(x), _mm256_set1_epi32(0xFFFF)), _mm256_slli_epi32(toSnorm(y), 16)));
+			}
+
+			friend void StorePixels(const AvxFloat8& r, const AvxFloat8& g, const AvxFloat8& b, const PixelFormat& format, uint32_t* pPixels)
+			{
+				const auto toByte{ [](const AvxFloat8& channel) { return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(channel.v, _mm256_set1_ps(255.f)), _mm256_setzero_ps()), _mm256_set1_ps(255.f))); } };
+				const __m256i red{ _mm256_sll_epi32(toByte(r), _mm_cvtsi32_si128(format.redShift)) };
+				const __m256i green{ _mm256_sll_epi32(toByte(g), _mm_cvtsi32_si128(format.greenShift)) };
+				const __m256i blue{ _mm256_sll_epi32(toByte(b), _mm_cvtsi32_si128(format.blueShift)) };
+				const __m256i alpha{ _mm256_set1_epi32(static_cast<int>(format.alphaMask)) };
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pPixels), _mm256_or_si256(_mm256_or_si256(red, green), _mm256_or_si256(blue, alpha)));
+			}
+
+		private:
+			static AvxFloat8 Log2Polynomial(const AvxFloat8& m);
+			static AvxFloat8 Exp2Polynomial(const AvxFloat8& f);
+		};
+
+		/* --- HELPER FUNCTIONS --- */
+		//c0 + c1 * x + ... + c5 * x^5
+		template<typename Float>
+		inline Float Polynomial5(const Float& x, float c0, float c1, float c2, float c3, float c4, float c5)
+		{
+			return ((((Float{ c5 } * x + c4) * x + c3) * x + c2) * x + c1) * x + c0;
+		}
+
+		//log2(m) / (m - 1) for m in [1, 2)
+		inline SseFloat4 SseFloat4::Log2Polynomial(const SseFloat4& m) { return Polynomial5(m, 3.1157899f, -3.3241990f, 2.5988452f, -1.2315303f, 3.1821337e-1f, -3.4436006e-2f); }
+		inline AvxFloat8 AvxFloat8::Log2Polynomial(const AvxFloat8& m) { return Polynomial5(m, 3.1157899f, -3.3241990f, 2.5988452f, -1.2315303f, 3.1821337e-1f, -3.4436006e-2f); }
+
+		//2^f for f in [0, 1)
+		inline SseFloat4 SseFloat4::Exp2Polynomial(const SseFloat4& f) { return Polynomial5(f, 9.9999994e-1f, 6.9315308e-1f, 2.4015361e-1f, 5.5826318e-2f, 8.9893397e-3f, 1.8775767e-3f); }
+		inline AvxFloat8 AvxFloat8::Exp2Polynomial(const AvxFloat8& f) { return Polynomial5(f, 9.9999994e-1f, 6.9315308e-1f, 2.4015361e-1f, 5.5826318e-2f, 8.9893397e-3f, 1.8775767e-3f); }
+
+		/* --- WIDE VECTOR TYPES --- */
+		template<typename Float>
+		struct Vector2
+		{
+			Float x{};
+			Float y{};
+		};
+
+		template<typename Float>
+		struct Vector3
+		{
+			Float x{};
+			Float y{};
+			Float z{};
+
+			Vector3 Normalized() const
+			{
+				const Float invMagnitude{ Float{ 1.f } / Sqrt(Dot(*this, *this)) };
+				return { x * invMagnitude, y * invMagnitude, z * invMagnitude };
+			}
+
+			static Float Dot(const Vector3& v1, const Vector3& v2)
+			{
+				return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+			}
+
+			static Vector3 Cross(const Vector3& v1, const Vector3& v2)
+			{
+				return {
+					v1.y * v2.z - v1.z * v2.y,
+					v1.z * v2.x - v1.x * v2.z,
+					v1.x * v2.y - v1.y * v2.x
+				};
+			}
+
+			Vector3 operator+(const Vector3& v) const { return { x + v.x, y + v.y, z + v.z }; }
+			Vector3 operator-(const Vector3& v) const { return { x - v.x, y - v.y, z - v.z }; }
+			Vector3 operator*(const Float& s) const { return { x * s, y * s, z * s }; }
+			Vector3 operator-() const { return { -x, -y, -z }; }
+		};
+
+		template<typename Float>
+		struct ColorRGB
+		{
+			Float r{};
+			Float g{};
+			Float b{};
+
+			void MaxToOne()
+			{
+				const Float maxValue{ Max(r, Max(g, b)) };
+				const Float scale{ Select(maxValue > 1.f, Float{ 1.f } / maxValue, Float{ 1.f }) };
+				r *= scale;
+				g *= scale;
+				b *= scale;
+			}
+
+			ColorRGB operator+(const ColorRGB& c) const { return { r + c.r, g + c.g, b + c.b }; }
+			ColorRGB operator*(const ColorRGB& c) const { return { r * c.r, g * c.g, b * c.b }; }
+			ColorRGB operator*(const Float& s) const { return { r * s, g * s, b * s }; }
+		};
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+//Standard includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace dae
+{
+	//order texels are stored in
+	enum class TexelLayout
+	{
+		//row by row, walking down a column jumps a whole row every texel
+		Linear,
+		//Z-order inside square tiles, every aligned 2^n x 2^n block of a tile is contiguous
+		Morton
+	};
+
+	//maps texel (x, y) of a width x height image to its index in memory
+	//a texel is any element of elementSize bytes, e.g. a packed color or a compressed block
+	class TexelAddressing final
+	{
+	public:
+		TexelAddressing() = default;
+		TexelAddressing(int width, int height, TexelLayout layout, size_t elementSize) :
+			m_Layout{ layout },
+			m_Width{ width }
+		{
+			if (m_Layout == TexelLayout::Linear)
+			{
+				m_TexelCount = static_cast<size_t>(width) * height;
+				return;
+			}
+
+			//tiles as big as the image up to a page, small mip levels don't get padded to a big tile
+			while ((static_cast<size_t>(1) << (2 * (m_TileShift + 1))) * elementSize <= PAGE_SIZE && (1 << m_TileShift) < std::max(width, height))
+			{
+				++m_TileShift;
+			}
+
+			const int tileSize{ 1 << m_TileShift };
+			const int tilesPerRow{ (width + tileSize - 1) / tileSize };
+			const int tilesPerColumn{ (height + tileSize - 1) / tileSize };
+
+			//power of 2 strides map every tile to the same cache sets, a cache line of padding shifts each tile & row of tiles a bit
+			const size_t padding{ std::max(CACHE_LINE_SIZE / elementSize, static_cast<size_t>(1)) };
+			m_TileStride = (static_cast<size_t>(1) << (2 * m_TileShift)) + padding;
+			m_TileRowStride = (m_TileStride * tilesPerRow) + padding;
+			m_TexelCount = m_TileRowStride * tilesPerColumn;
+		}
+
+		//includes the padding of the last row & column of tiles
+		size_t GetTexelCount() const { return m_TexelCount; };
+
+		size_t GetIndex(int x, int y) const
+		{
+			if (m_Layout == TexelLayout::Linear)
+			{
+				return x + (static_cast<size_t>(y) * m_Width);
+			}
+
+			const int tileMask{ (1 << m_TileShift) - 1 };
+			const size_t tileStart{ (static_cast<size_t>(x >> m_TileShift) * m_TileStride) + (static_cast<size_t>(y >> m_TileShift) * m_TileRowStride) };
+			return tileStart + (SpreadBits(x & tileMask) | (SpreadBits(y & tileMask) << 1));
+		}
+
+	private:
+		//a tile fits in one page => 32x32 texels of 4 bytes, 16x16 of 16 bytes
+		static constexpr size_t PAGE_SIZE{ 4096 };
+		static constexpr size_t CACHE_LINE_SIZE{ 64 };
+
+		//abcde => 0a0b0c0d0e
+		static uint32_t SpreadBits(uint32_t value)
+		{
+			value = (value | (value << 8)) & 0x00FF00FF;
+			value = (value | (value << 4)) & 0x0F0F0F0F;
+			value = (value | (value << 2)) & 0x33333333;
+			value = (value | (value << 1)) & 0x55555555;
+			return value;
+		}
+
+		TexelLayout m_Layout{ TexelLayout::Linear };
+		int m_Width{};
+		int m_TileShift{};
+		size_t m_TileStride{};
+		size_t m_TileRowStride{};
+		size_t m_TexelCount{};
+	};
+}
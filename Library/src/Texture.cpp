@@ -1,26 +1,73 @@
 #include "Texture.h"
 #include "Vector2.h"
 #include <SDL_image.h>
+#include <algorithm>
 #include <memory>
 
 namespace dae
 {
-	Texture::Texture(SDL_Surface* pSurface) :
-		m_SurfacePtr{ pSurface },
-		m_SurfacePixelsPtr{ (uint32_t*)pSurface->pixels }
+	Texture::Texture(SDL_Surface* pSurface, TexelLayout layout, TextureFormat format) :
+		m_Format{ format },
+		m_Width{ pSurface->w },
+		m_Height{ pSurface->h }
 	{
-	}
+		//rows of the surface can be padded, texels past the edge repeat the last row/column
+		const auto getSurfaceTexel{ [pSurface](int px, int py)
+			{
+				px = std::min(px, pSurface->w - 1);
+				py = std::min(py, pSurface->h - 1);
+				return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(pSurface->pixels) + py * pSurface->pitch)[px];
+			} };
 
-	Texture::~Texture()
-	{
-		if (m_SurfacePtr)
+		if (m_Format == TextureFormat::RGBA8)
+		{
+			m_Addressing = TexelAddressing{ m_Width, m_Height, layout, sizeof(uint32_t) };
+			m_Texels.resize(m_Addressing.GetTexelCount());
+			for (int py{}; py < m_Height; ++py)
+			{
+				for (int px{}; px < m_Width; ++px)
+				{
+					m_Texels[m_Addressing.GetIndex(px, py)] = getSurfaceTexel(px, py);
+				}
+			}
+			return;
+		}
+
+		const int blockCountX{ (m_Width + 3) / 4 };
+		const int blockCountY{ (m_Height + 3) / 4 };
+		m_Addressing = TexelAddressing{ blockCountX, blockCountY, layout, (m_Format == TextureFormat::BC1) ? sizeof(Bc1Block) : sizeof(Bc3Block) };
+		if (m_Format == TextureFormat::BC1)
+		{
+			m_Bc1Blocks.resize(m_Addressing.GetTexelCount());
+		}
+		else
+		{
+			m_Bc3Blocks.resize(m_Addressing.GetTexelCount());
+		}
+
+		for (int blockY{}; blockY < blockCountY; ++blockY)
 		{
-			SDL_FreeSurface(m_SurfacePtr);
-			m_SurfacePtr = nullptr;
+			for (int blockX{}; blockX < blockCountX; ++blockX)
+			{
+				uint32_t blockTexels[16]{};
+				for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+				{
+					blockTexels[texelIdx] = getSurfaceTexel(blockX * 4 + (texelIdx & 3), blockY * 4 + (texelIdx >> 2));
+				}
+
+				if (m_Format == TextureFormat::BC1)
+				{
+					m_Bc1Blocks[m_Addressing.GetIndex(blockX, blockY)] = EncodeBc1(blockTexels);
+				}
+				else
+				{
+					m_Bc3Blocks[m_Addressing.GetIndex(blockX, blockY)] = EncodeBc3(blockTexels);
+				}
+			}
 		}
 	}
 
-	Texture* Texture::LoadFromFile(const std::string& path)
+	Texture* Texture::LoadFromFile(const std::string& path, TexelLayout layout, TextureFormat format)
 	{
 		//Load SDL_Surface using IMG_LOAD
 		//Create & Return a new Texture Object (using SDL_Surface)
@@ -32,26 +79,50 @@ namespace dae
 			return nullptr;
 		}
 
-		return new Texture{texturePtr};
+		//RGBA32 is R, G, B, A in memory whatever the endianness => 0xAABBGGRR on little endian
+		SDL_Surface* convertedPtr{ SDL_ConvertSurfaceFormat(texturePtr, SDL_PIXELFORMAT_RGBA32, 0) };
+		SDL_FreeSurface(texturePtr);
+
+		if (!convertedPtr)
+		{
+			return nullptr;
+		}
+
+		Texture* pTexture{ new Texture{ convertedPtr, layout, format } };
+		SDL_FreeSurface(convertedPtr);
+		return pTexture;
 	}
 
 	ColorRGB Texture::Sample(const Vector2& uv) const
 	{
-		//Sample the correct texel for the given uv
-		const float px{ m_SurfacePtr->w * uv.x };
-		const float py{ m_SurfacePtr->h * uv.y };
-		const uint32_t pIndex{ static_cast<uint32_t>(px) + (static_cast<uint32_t>(py) * m_SurfacePtr->w) };
+		return TexelToColor(SampleTexel(uv));
+	}
 
-		uint8_t r{};
-		uint8_t g{};
-		uint8_t b{};
+	uint32_t Texture::SampleTexel(const Vector2& uv) const
+	{
+		//Sample the correct texel for the given uv, uv == 1 stays on the last texel
+		const int px{ std::min(static_cast<int>(m_Width * uv.x), m_Width - 1) };
+		const int py{ std::min(static_cast<int>(m_Height * uv.y), m_Height - 1) };
 
-		SDL_GetRGB(m_SurfacePixelsPtr[pIndex], m_SurfacePtr->format, &r, &g, &b);
+		switch (m_Format)
+		{
+		case TextureFormat::BC1:
+			return DecodeBc1(m_Bc1Blocks[m_Addressing.GetIndex(px >> 2, py >> 2)], (px & 3) + ((py & 3) << 2));
+		case TextureFormat::BC3:
+			return DecodeBc3(m_Bc3Blocks[m_Addressing.GetIndex(px >> 2, py >> 2)], (px & 3) + ((py & 3) << 2));
+		default:
+			return m_Texels[m_Addressing.GetIndex(px, py)];
+		}
+	}
 
-		float rFloat{ r / 255.f }; 
-		float gFloat{ g / 255.f }; 
-		float bFloat{ b / 255.f }; 
+	size_t Texture::GetMemorySize() const
+	{
+		return m_Texels.size() * sizeof(uint32_t) + m_Bc1Blocks.size() * sizeof(Bc1Block) + m_Bc3Blocks.size() * sizeof(Bc3Block);
+	}
 
-		return ColorRGB{ rFloat,gFloat,bFloat }; 
+	ColorRGB Texture::TexelToColor(uint32_t texel)
+	{
+		constexpr float toFloat{ 1.f / 255.f };
+		return ColorRGB{ (texel & 0xFF) * toFloat, ((texel >> 8) & 0xFF) * toFloat, ((texel >> 16) & 0xFF) * toFloat };
 	}
 }
\ No newline at end of file
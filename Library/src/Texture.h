@@ -1,7 +1,10 @@
 #pragma once
 #include <SDL_surface.h>
 #include <string>
+#include <vector>
+#include "BlockCompression.h"
 #include "ColorRGB.h"
+#include "TexelLayout.h"
 
 namespace dae
 {
@@ -10,15 +13,32 @@ namespace dae
 	class Texture
 	{
 	public:
-		~Texture();
+		~Texture() = default;
 
-		static Texture* LoadFromFile(const std::string& path);
+		//block compressed formats are encoded here, once
+		static Texture* LoadFromFile(const std::string& path, TexelLayout layout = TexelLayout::Linear, TextureFormat format = TextureFormat::RGBA8);
 		ColorRGB Sample(const Vector2& uv) const;
+		//packed texel, 0xAABBGGRR
+		uint32_t SampleTexel(const Vector2& uv) const;
+		static ColorRGB TexelToColor(uint32_t texel);
+
+		int GetWidth() const { return m_Width; };
+		int GetHeight() const { return m_Height; };
+		//bytes the texels take up
+		size_t GetMemorySize() const;
 
 	private:
-		Texture(SDL_Surface* pSurface);
+		Texture(SDL_Surface* pSurface, TexelLayout layout, TextureFormat format);
 
-		SDL_Surface* m_SurfacePtr{ nullptr };
-		uint32_t* m_SurfacePixelsPtr{ nullptr };
+		//texels as 0xAABBGGRR, converted once when loading => Sample never needs SDL's pixel format
+		std::vector<uint32_t> m_Texels{};
+		//only the vector of m_Format is filled
+		std::vector<Bc1Block> m_Bc1Blocks{};
+		std::vector<Bc3Block> m_Bc3Blocks{};
+		//addresses 4x4 blocks instead of texels for the compressed formats
+		TexelAddressing m_Addressing{};
+		TextureFormat m_Format{};
+		int m_Width{};
+		int m_Height{};
 	};
 }
\ No newline at end of file
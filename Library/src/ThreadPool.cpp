@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace dae
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+		{
+			//hardware_concurrency may return 0 when it can't tell
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		//the thread calling ParallelFor is the last one
+		m_Workers.reserve(threadCount - 1);
+		for (uint32_t workerIdx{ 1 }; workerIdx < threadCount; ++workerIdx)
+		{
+			m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_WakeCondition.notify_all();
+
+		for (std::thread& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void ThreadPool::Dispatch(uint32_t count, JobFunction pFunction, const void* pJob)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		//nothing to share, skip the wake up round trip
+		if (m_Workers.empty() || count == 1)
+		{
+			for (uint32_t index{}; index < count; ++index)
+			{
+				pFunction(pJob, index);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_pJobFunction = pFunction;
+			m_pJob = pJob;
+			m_JobCount = count;
+			m_NextJobIdx.store(0, std::memory_order_relaxed);
+			m_FinishedWorkerCount = 0;
+			++m_Generation;
+		}
+		m_WakeCondition.notify_all();
+
+		RunJobs();
+
+		//every worker has to be done with this generation before the job can go out of scope
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+		m_DoneCondition.wait(lock, [this] { return m_FinishedWorkerCount == m_Workers.size(); });
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		uint64_t seenGeneration{};
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_WakeCondition.wait(lock, [this, seenGeneration] { return m_IsStopping || m_Generation != seenGeneration; });
+
+				if (m_IsStopping)
+				{
+					return;
+				}
+
+				seenGeneration = m_Generation;
+			}
+
+			RunJobs();
+
+			bool isLastWorker{};
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				isLastWorker = (++m_FinishedWorkerCount == m_Workers.size());
+			}
+
+			if (isLastWorker)
+			{
+				m_DoneCondition.notify_one();
+			}
+		}
+	}
+
+	void ThreadPool::RunJobs()
+	{
+		//grab indices one at a time, uneven jobs (e.g. busy tiles) balance out by themselves
+		for (uint32_t index{ m_NextJobIdx.fetch_add(1) }; index < m_JobCount; index = m_NextJobIdx.fetch_add(1))
+		{
+			m_pJobFunction(m_pJob, index);
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+//Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class ThreadPool final
+	{
+	public:
+		//threadCount includes the calling thread, 0 => one thread per hardware thread
+		explicit ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) noexcept = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+		//calls job(index) once for every index in [0, count)
+		//the calling thread works along and only returns when every index is done
+		template<typename Job>
+		void ParallelFor(uint32_t count, const Job& job)
+		{
+			Dispatch(count, [](const void* pJob, uint32_t index) { (*static_cast<const Job*>(pJob))(index); }, &job);
+		}
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()) + 1; };
+
+	private:
+		using JobFunction = void(*)(const void* pJob, uint32_t index);
+
+		void Dispatch(uint32_t count, JobFunction pFunction, const void* pJob);
+		void WorkerLoop();
+		void RunJobs();
+
+		std::vector<std::thread> m_Workers{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_WakeCondition{};
+		std::condition_variable m_DoneCondition{};
+
+		//current job, only written while no worker is running it
+		JobFunction m_pJobFunction{ nullptr };
+		const void* m_pJob{ nullptr };
+		uint32_t m_JobCount{};
+		std::atomic<uint32_t> m_NextJobIdx{};
+
+		uint64_t m_Generation{};
+		uint32_t m_FinishedWorkerCount{};
+		bool m_IsStopping{ false };
+	};
+}
@@ -1,8 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <string_view>
+#include <unordered_map>
 #include "Maths.h"
 #include "DataTypes.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 
 //#define DISABLE_OBJ
 
@@ -10,124 +19,373 @@ namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
+		//a face corner is its position/uv/normal indices, equal corners share one vertex
+		struct ObjVertexKey
+		{
+			size_t iPosition{};
+			size_t iTexCoord{};
+			size_t iNormal{};
+
+			bool operator==(const ObjVertexKey& key) const
+			{
+				return iPosition == key.iPosition && iTexCoord == key.iTexCoord && iNormal == key.iNormal;
+			}
+		};
+
+		struct ObjVertexKeyHash
+		{
+			size_t operator()(const ObjVertexKey& key) const
+			{
+				return (key.iPosition * 73856093) ^ (key.iTexCoord * 19349663) ^ (key.iNormal * 83492791);
+			}
+		};
+
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+
+		//a new group starts at every o, g & usemtl statement and runs up to the next one
+		struct ObjGroup
 		{
-#ifdef DISABLE_OBJ
+			std::string objectName{};
+			std::string groupName{};
+			std::string materialName{};
+			uint32_t firstIndex{};
+			uint32_t indexCount{};
+		};
 
-			//Enable the code below after uncommenting all the vertex attributes of DataTypes::Vertex
-			// >> Comment/Remove '#define DISABLE_OBJ'
-			assert(false && "OBJ PARSER not enabled! Check the comments in Utils::ParseOBJ");
+		//indices of a face corner as written in the file, 0 => missing
+		//relative (negative) indices are already counted from the start of their chunk
+		struct ObjFaceCorner
+		{
+			int32_t iPosition{};
+			int32_t iTexCoord{};
+			int32_t iNormal{};
+			uint8_t flags{};
+		};
 
-#else
+		static constexpr uint8_t OBJ_POSITION_RELATIVE{ 1 << 0 };
+		static constexpr uint8_t OBJ_TEXCOORD_RELATIVE{ 1 << 1 };
+		static constexpr uint8_t OBJ_NORMAL_RELATIVE{ 1 << 2 };
 
-			std::ifstream file(filename);
-			if (!file)
-				return false;
+		//o, g or usemtl, applies from faceIdx of its chunk on
+		struct ObjStatement
+		{
+			char command{};
+			std::string_view name{};
+			uint32_t faceIdx{};
+		};
 
+		//everything one chunk of lines of an OBJ declares
+		struct ObjChunk
+		{
 			std::vector<Vector3> positions{};
-			std::vector<Vector3> normals{};
 			std::vector<Vector2> UVs{};
+			std::vector<Vector3> normals{};
+			std::vector<ObjFaceCorner> corners{};
+			std::vector<uint32_t> faceSizes{};
+			std::vector<ObjStatement> statements{};
+		};
 
-			vertices.clear();
-			indices.clear();
+		//files are split in chunks of at least this many bytes to parse them on multiple threads
+		static constexpr size_t OBJ_MIN_CHUNK_SIZE{ 256 * 1024 };
 
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
+		//tokens are separated by spaces or tabs
+		static const char* SkipObjSpaces(const char* pCurrent, const char* pEnd)
+		{
+			while (pCurrent < pEnd && (*pCurrent == ' ' || *pCurrent == '\t'))
+				++pCurrent;
+			return pCurrent;
+		}
+
+		static const char* ParseObjFloat(const char* pCurrent, const char* pEnd, float& value)
+		{
+			pCurrent = SkipObjSpaces(pCurrent, pEnd);
+			//from_chars doesn't take a leading '+'
+			if (pCurrent < pEnd && *pCurrent == '+')
+				++pCurrent;
+			return std::from_chars(pCurrent, pEnd, value).ptr;
+		}
+
+		//a negative index counts back from the elements declared so far
+		static bool ParseObjIndex(const char*& pCurrent, const char* pEnd, size_t count, int32_t& index, uint8_t& flags, uint8_t relativeFlag)
+		{
+			int32_t value{};
+			const std::from_chars_result result{ std::from_chars(pCurrent, pEnd, value) };
+			if (result.ptr == pCurrent)
+				return false;
+
+			pCurrent = result.ptr;
+			if (value < 0)
 			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
-				{
-					// Ignore Comment
-				}
-				else if (sCommand == "v")
+				index = int32_t(count) + value + 1;
+				flags |= relativeFlag;
+			}
+			else
+			{
+				index = value;
+			}
+			return true;
+		}
+
+		static void ParseOBJChunk(const char* pCurrent, const char* pEnd, ObjChunk& chunk)
+		{
+			while (pCurrent < pEnd)
+			{
+				const char* pLineEnd{ static_cast<const char*>(std::memchr(pCurrent, '\n', size_t(pEnd - pCurrent))) };
+				if (!pLineEnd)
+					pLineEnd = pEnd;
+
+				//the command is the first word of the line
+				pCurrent = SkipObjSpaces(pCurrent, pLineEnd);
+				const char* pCommandEnd{ pCurrent };
+				while (pCommandEnd < pLineEnd && *pCommandEnd != ' ' && *pCommandEnd != '\t' && *pCommandEnd != '\r')
+					++pCommandEnd;
+
+				const std::string_view command{ pCurrent, size_t(pCommandEnd - pCurrent) };
+				pCurrent = pCommandEnd;
+
+				if (command == "v")
 				{
 					//Vertex
-					float x, y, z;
-					file >> x >> y >> z;
-
-					positions.emplace_back(x, y, z);
+					Vector3& position{ chunk.positions.emplace_back() };
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, position.x);
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, position.y);
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, position.z);
 				}
-				else if (sCommand == "vt")
+				else if (command == "vt")
 				{
 					// Vertex TexCoord
-					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
+					float u{}, v{};
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, u);
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, v);
+					chunk.UVs.emplace_back(u, 1 - v);
 				}
-				else if (sCommand == "vn")
+				else if (command == "vn")
 				{
 					// Vertex Normal
-					float x, y, z;
-					file >> x >> y >> z;
-
-					normals.emplace_back(x, y, z);
+					Vector3& normal{ chunk.normals.emplace_back() };
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, normal.x);
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, normal.y);
+					pCurrent = ParseObjFloat(pCurrent, pLineEnd, normal.z);
 				}
-				else if (sCommand == "f")
+				else if (command == "f")
 				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
-					uint32_t tempIndices[3];
-					for (size_t iFace = 0; iFace < 3; iFace++)
+					//any number of v, v/vt, v//vn or v/vt/vn corners
+					uint32_t cornerCount{};
+					while (true)
 					{
-						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
+						pCurrent = SkipObjSpaces(pCurrent, pLineEnd);
+
+						ObjFaceCorner corner{};
+						if (!ParseObjIndex(pCurrent, pLineEnd, chunk.positions.size(), corner.iPosition, corner.flags, OBJ_POSITION_RELATIVE))
+							break;
 
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
+						if (pCurrent < pLineEnd && *pCurrent == '/')
 						{
-							file.ignore();//read and ignore one element ('/')
+							++pCurrent;
 
-							if ('/' != file.peek())
-							{
-								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
-							}
+							// Optional texture coordinate
+							ParseObjIndex(pCurrent, pLineEnd, chunk.UVs.size(), corner.iTexCoord, corner.flags, OBJ_TEXCOORD_RELATIVE);
 
-							if ('/' == file.peek())
+							if (pCurrent < pLineEnd && *pCurrent == '/')
 							{
-								file.ignore();
+								++pCurrent;
 
 								// Optional vertex normal
-								file >> iNormal;
-								vertex.normal = normals[iNormal - 1];
+								ParseObjIndex(pCurrent, pLineEnd, chunk.normals.size(), corner.iNormal, corner.flags, OBJ_NORMAL_RELATIVE);
 							}
 						}
 
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
+						chunk.corners.push_back(corner);
+						++cornerCount;
 					}
 
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding) 
+					//lines & points aren't faces
+					if (cornerCount >= 3)
+						chunk.faceSizes.push_back(cornerCount);
+					else
+						chunk.corners.resize(chunk.corners.size() - cornerCount);
+				}
+				else if (command == "o" || command == "g" || command == "usemtl")
+				{
+					//the name is the rest of the line
+					const char* pNameStart{ SkipObjSpaces(pCurrent, pLineEnd) };
+					const char* pNameEnd{ pLineEnd };
+					while (pNameEnd > pNameStart && (pNameEnd[-1] == ' ' || pNameEnd[-1] == '\t' || pNameEnd[-1] == '\r'))
+						--pNameEnd;
+
+					chunk.statements.push_back({ command[0], std::string_view{ pNameStart, size_t(pNameEnd - pNameStart) }, uint32_t(chunk.faceSizes.size()) });
+				}
+				//comments, s, mtllib, ... are skipped
+
+				pCurrent = pLineEnd + 1;
+			}
+		}
+
+		//Parses vertices and indices, polygons are triangulated as a fan
+		//with a thread pool, big files get parsed in chunks on every thread
+		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true, ThreadPool* pThreadPool = nullptr, std::vector<ObjGroup>* pGroups = nullptr)
+		{
+#ifdef DISABLE_OBJ
+
+			//Enable the code below after uncommenting all the vertex attributes of DataTypes::Vertex
+			// >> Comment/Remove '#define DISABLE_OBJ'
+			assert(false && "OBJ PARSER not enabled! Check the comments in Utils::ParseOBJ");
+
+#else
+
+			const MappedFile file{ filename };
+			if (!file.IsOpen())
+				return false;
+
+			const char* pBegin{ reinterpret_cast<const char*>(file.GetData()) };
+			const char* pEnd{ pBegin + file.GetSize() };
+
+			//chunks are split at line ends
+			size_t chunkCount{ 1 };
+			if (pThreadPool)
+				chunkCount = std::clamp(file.GetSize() / OBJ_MIN_CHUNK_SIZE, size_t{ 1 }, size_t{ pThreadPool->GetThreadCount() } * 4);
+
+			std::vector<const char*> chunkStarts(chunkCount + 1, pEnd);
+			chunkStarts[0] = pBegin;
+			for (size_t chunkIdx{ 1 }; chunkIdx < chunkCount; ++chunkIdx)
+			{
+				const char* pSplit{ std::max(pBegin + file.GetSize() * chunkIdx / chunkCount, chunkStarts[chunkIdx - 1]) };
+				const char* pLineEnd{ static_cast<const char*>(std::memchr(pSplit, '\n', size_t(pEnd - pSplit))) };
+				chunkStarts[chunkIdx] = pLineEnd ? pLineEnd + 1 : pEnd;
+			}
+
+			std::vector<ObjChunk> chunks(chunkCount);
+			const auto parseChunk{ [&chunkStarts, &chunks](uint32_t chunkIdx) { ParseOBJChunk(chunkStarts[chunkIdx], chunkStarts[size_t(chunkIdx) + 1], chunks[chunkIdx]); } };
+			if (pThreadPool)
+				pThreadPool->ParallelFor(uint32_t(chunkCount), parseChunk);
+			else
+				parseChunk(0);
+
+			//chunks only know their own elements => put them after each other
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+			std::vector<ObjFaceCorner> chunkOffsets(chunkCount);
+			for (size_t chunkIdx{}; chunkIdx < chunkCount; ++chunkIdx)
+			{
+				chunkOffsets[chunkIdx] = { int32_t(positions.size()), int32_t(UVs.size()), int32_t(normals.size()) };
+				positions.insert(positions.end(), chunks[chunkIdx].positions.begin(), chunks[chunkIdx].positions.end());
+				UVs.insert(UVs.end(), chunks[chunkIdx].UVs.begin(), chunks[chunkIdx].UVs.end());
+				normals.insert(normals.end(), chunks[chunkIdx].normals.begin(), chunks[chunkIdx].normals.end());
+			}
+
+			vertices.clear();
+			indices.clear();
+			if (pGroups)
+			{
+				pGroups->clear();
+				pGroups->emplace_back();
+			}
+
+			//index of the vertex made for every distinct face corner
+			std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertexLookup{};
+			vertexLookup.reserve(positions.size());
+
+			const auto applyStatement{ [pGroups, &indices](const ObjStatement& statement)
+				{
+					if (!pGroups)
+						return;
+
+					//statements in a row before any face change the same group
+					if (pGroups->back().indexCount != 0)
 					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
+						pGroups->push_back(pGroups->back());
+						pGroups->back().firstIndex = uint32_t(indices.size());
+						pGroups->back().indexCount = 0;
 					}
-					else
+
+					ObjGroup& group{ pGroups->back() };
+					switch (statement.command)
 					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
+					case 'o': group.objectName = statement.name; break;
+					case 'g': group.groupName = statement.name; break;
+					default: group.materialName = statement.name; break;
+					}
+				} };
+
+			for (size_t chunkIdx{}; chunkIdx < chunkCount; ++chunkIdx)
+			{
+				const ObjChunk& chunk{ chunks[chunkIdx] };
+				const ObjFaceCorner& offset{ chunkOffsets[chunkIdx] };
+				size_t cornerIdx{};
+				size_t statementIdx{};
+
+				for (uint32_t faceIdx{}; faceIdx < chunk.faceSizes.size(); ++faceIdx)
+				{
+					while (statementIdx < chunk.statements.size() && chunk.statements[statementIdx].faceIdx == faceIdx)
+						applyStatement(chunk.statements[statementIdx++]);
+
+					uint32_t firstIndex{};
+					uint32_t previousIndex{};
+					for (uint32_t faceCornerIdx{}; faceCornerIdx < chunk.faceSizes[faceIdx]; ++faceCornerIdx)
+					{
+						const ObjFaceCorner& corner{ chunk.corners[cornerIdx++] };
+
+						//global OBJ indices, 1-based & 0 => missing
+						const int64_t iPosition{ corner.iPosition + ((corner.flags & OBJ_POSITION_RELATIVE) ? int64_t(offset.iPosition) : 0) };
+						const int64_t iTexCoord{ corner.iTexCoord + ((corner.flags & OBJ_TEXCOORD_RELATIVE) ? int64_t(offset.iTexCoord) : 0) };
+						const int64_t iNormal{ corner.iNormal + ((corner.flags & OBJ_NORMAL_RELATIVE) ? int64_t(offset.iNormal) : 0) };
+
+						if (iPosition < 1 || iPosition > int64_t(positions.size()) ||
+							iTexCoord < 0 || iTexCoord > int64_t(UVs.size()) ||
+							iNormal < 0 || iNormal > int64_t(normals.size()))
+							return false;
+
+						//reuse the vertex of an earlier identical corner
+						const ObjVertexKey key{ size_t(iPosition), size_t(iTexCoord), size_t(iNormal) };
+						const auto [it, isNewVertex] { vertexLookup.try_emplace(key, uint32_t(vertices.size())) };
+						if (isNewVertex)
+						{
+							Vertex vertex{};
+							vertex.position = positions[key.iPosition - 1];
+							if (key.iTexCoord != 0)
+								vertex.uv = UVs[key.iTexCoord - 1];
+							if (key.iNormal != 0)
+								vertex.normal = normals[key.iNormal - 1];
+
+							vertices.push_back(vertex);
+						}
+
+						const uint32_t index{ it->second };
+						if (faceCornerIdx == 0)
+						{
+							firstIndex = index;
+						}
+						else if (faceCornerIdx >= 2)
+						{
+							indices.push_back(firstIndex);
+							if (flipAxisAndWinding)
+							{
+								indices.push_back(index);
+								indices.push_back(previousIndex);
+							}
+							else
+							{
+								indices.push_back(previousIndex);
+								indices.push_back(index);
+							}
+
+							if (pGroups)
+								pGroups->back().indexCount += 3;
+						}
+						previousIndex = index;
 					}
 				}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
+
+				//statements after the last face of the chunk
+				while (statementIdx < chunk.statements.size())
+					applyStatement(chunk.statements[statementIdx++]);
 			}
 
+			if (pGroups && pGroups->size() > 1 && pGroups->back().indexCount == 0)
+				pGroups->pop_back();
+
 			//Cheap Tangent Calculations
 			for (uint32_t i = 0; i < indices.size(); i += 3)
 			{
@@ -171,6 +429,189 @@ namespace dae
 			return true;
 #endif
 		}
+
+		//------ Binary Mesh Cache ------
+		//header, vertex streams one after the other (padded like in memory), index buffer
+		//only what the renderer reads is stored => loading is a copy per stream, no Vertex ever gets built
+		static constexpr uint32_t MESH_CACHE_MAGIC{ 0x4D454144 }; //"DAEM"
+		static constexpr uint32_t MESH_CACHE_VERSION{ 4 };
+		static constexpr uint32_t VERTEX_STREAM_COUNT{ 11 };
+
+		struct MeshCacheHeader
+		{
+			uint32_t magic{ MESH_CACHE_MAGIC };
+			uint32_t version{ MESH_CACHE_VERSION };
+			//different streams or padding invalidate every cache
+			uint32_t streamCount{ VERTEX_STREAM_COUNT };
+			uint32_t streamPadding{ uint32_t(VertexStreams::PADDING) };
+			//without the padding
+			uint32_t vertexCount{};
+			uint32_t indexCount{};
+			uint32_t primitiveTopology{};
+			//the ParseOBJ flag the vertices & indices were made with, flipped & unflipped caches aren't interchangeable
+			uint32_t isFlipped{};
+			Vector3 boundsMin{};
+			Vector3 boundsMax{};
+			Vector3 boundsCenter{};
+			float boundsRadius{};
+		};
+
+		static void CalculateBounds(const std::vector<Vertex>& vertices, Vector3& boundsMin, Vector3& boundsMax)
+		{
+			if (vertices.empty())
+			{
+				boundsMin = boundsMax = Vector3{};
+				return;
+			}
+
+			boundsMin = boundsMax = vertices[0].position;
+			for (const Vertex& vertex : vertices)
+			{
+				boundsMin = Vector3{ std::min(boundsMin.x, vertex.position.x), std::min(boundsMin.y, vertex.position.y), std::min(boundsMin.z, vertex.position.z) };
+				boundsMax = Vector3{ std::max(boundsMax.x, vertex.position.x), std::max(boundsMax.y, vertex.position.y), std::max(boundsMax.z, vertex.position.z) };
+			}
+		}
+
+		//centered on the bounding box, the radius reaches the farthest vertex => tighter than half the box diagonal
+		static void CalculateBoundingSphere(const std::vector<Vertex>& vertices, const Vector3& boundsMin, const Vector3& boundsMax, Vector3& center, float& radius)
+		{
+			center = (boundsMin + boundsMax) / 2.f;
+
+			float sqrRadius{};
+			for (const Vertex& vertex : vertices)
+			{
+				sqrRadius = std::max(sqrRadius, (vertex.position - center).SqrMagnitude());
+			}
+			radius = std::sqrt(sqrRadius);
+		}
+
+		//every stream of a VertexStreams, const or not, in the order the cache stores them
+		template<typename Streams>
+		static auto GetStreams(Streams& streams)
+		{
+			return std::array{ &streams.positionX, &streams.positionY, &streams.positionZ, &streams.normalX, &streams.normalY, &streams.normalZ, &streams.tangentX, &streams.tangentY, &streams.tangentZ, &streams.uvX, &streams.uvY };
+		}
+
+		static size_t GetPaddedVertexCount(size_t vertexCount)
+		{
+			return (vertexCount + VertexStreams::PADDING - 1) / VertexStreams::PADDING * VertexStreams::PADDING;
+		}
+
+		static void BuildVertexStreams(const std::vector<Vertex>& vertices, VertexStreams& streams)
+		{
+			streams.vertexCount = vertices.size();
+			const size_t paddedCount{ GetPaddedVertexCount(vertices.size()) };
+			const auto pStreams{ GetStreams(streams) };
+			static_assert(pStreams.size() == VERTEX_STREAM_COUNT);
+			for (std::vector<float>* pStream : pStreams)
+			{
+				pStream->assign(paddedCount, 0.f);
+			}
+
+			for (size_t vertexIdx{}; vertexIdx < vertices.size(); ++vertexIdx)
+			{
+				const Vertex& vertex{ vertices[vertexIdx] };
+				const Vector3* pComponents[]{ &vertex.position, &vertex.normal, &vertex.tangent };
+				for (int componentIdx{}; componentIdx < 3; ++componentIdx)
+				{
+					(*pStreams[componentIdx * 3 + 0])[vertexIdx] = pComponents[componentIdx]->x;
+					(*pStreams[componentIdx * 3 + 1])[vertexIdx] = pComponents[componentIdx]->y;
+					(*pStreams[componentIdx * 3 + 2])[vertexIdx] = pComponents[componentIdx]->z;
+				}
+				streams.uvX[vertexIdx] = vertex.uv.x;
+				streams.uvY[vertexIdx] = vertex.uv.y;
+			}
+		}
+
+		static bool SaveMeshCache(const std::string& filename, const Mesh& mesh, bool flipAxisAndWinding = true)
+		{
+			std::ofstream file(filename, std::ios::binary);
+			if (!file)
+				return false;
+
+			MeshCacheHeader header{};
+			header.vertexCount = uint32_t(mesh.vertexStreams.vertexCount);
+			header.indexCount = uint32_t(mesh.indices.size());
+			header.primitiveTopology = uint32_t(mesh.primitiveTopology);
+			header.isFlipped = uint32_t(flipAxisAndWinding);
+			header.boundsMin = mesh.boundsMin;
+			header.boundsMax = mesh.boundsMax;
+			header.boundsCenter = mesh.boundsCenter;
+			header.boundsRadius = mesh.boundsRadius;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			const size_t paddedCount{ GetPaddedVertexCount(mesh.vertexStreams.vertexCount) };
+			for (const std::vector<float>* pStream : GetStreams(mesh.vertexStreams))
+			{
+				file.write(reinterpret_cast<const char*>(pStream->data()), std::streamsize(paddedCount * sizeof(float)));
+			}
+			file.write(reinterpret_cast<const char*>(mesh.indices.data()), std::streamsize(mesh.indices.size() * sizeof(uint32_t)));
+			return bool(file);
+		}
+
+		//no parsing, the streams & indices are copied straight out of the mapped file, mesh.vertices stays empty
+		static bool LoadMeshCache(const std::string& filename, Mesh& mesh, bool flipAxisAndWinding = true)
+		{
+			const MappedFile file{ filename };
+			if (!file.IsOpen() || file.GetSize() < sizeof(MeshCacheHeader))
+				return false;
+
+			const MeshCacheHeader& header{ *reinterpret_cast<const MeshCacheHeader*>(file.GetData()) };
+			if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.streamCount != VERTEX_STREAM_COUNT || header.streamPadding != VertexStreams::PADDING || header.isFlipped != uint32_t(flipAxisAndWinding))
+				return false;
+
+			const size_t paddedCount{ GetPaddedVertexCount(header.vertexCount) };
+			const size_t vertexBytes{ VERTEX_STREAM_COUNT * paddedCount * sizeof(float) };
+			const size_t indexBytes{ size_t(header.indexCount) * sizeof(uint32_t) };
+			if (file.GetSize() != sizeof(MeshCacheHeader) + vertexBytes + indexBytes)
+				return false;
+
+			const float* pStreamData{ reinterpret_cast<const float*>(file.GetData() + sizeof(MeshCacheHeader)) };
+			const uint32_t* pIndices{ reinterpret_cast<const uint32_t*>(file.GetData() + sizeof(MeshCacheHeader) + vertexBytes) };
+
+			mesh.vertexStreams.vertexCount = header.vertexCount;
+			for (std::vector<float>* pStream : GetStreams(mesh.vertexStreams))
+			{
+				pStream->assign(pStreamData, pStreamData + paddedCount);
+				pStreamData += paddedCount;
+			}
+			mesh.indices.assign(pIndices, pIndices + header.indexCount);
+			mesh.primitiveTopology = PrimitiveTopology(header.primitiveTopology);
+			mesh.boundsMin = header.boundsMin;
+			mesh.boundsMax = header.boundsMax;
+			mesh.boundsCenter = header.boundsCenter;
+			mesh.boundsRadius = header.boundsRadius;
+			return true;
+		}
+
+		//loads <filename>.mesh when it's newer than the OBJ, otherwise parses the OBJ and writes the cache for next time
+		static bool LoadMesh(const std::string& filename, Mesh& mesh, bool flipAxisAndWinding = true, ThreadPool* pThreadPool = nullptr)
+		{
+			const std::string cacheFilename{ filename + ".mesh" };
+
+			std::error_code error{};
+			const auto objTime{ std::filesystem::last_write_time(filename, error) };
+			const bool hasObj{ !error };
+			const auto cacheTime{ std::filesystem::last_write_time(cacheFilename, error) };
+			const bool isCacheValid{ !error && (!hasObj || cacheTime >= objTime) };
+
+			if (isCacheValid && LoadMeshCache(cacheFilename, mesh, flipAxisAndWinding))
+			{
+				return true;
+			}
+
+			if (!ParseOBJ(filename, mesh.vertices, mesh.indices, flipAxisAndWinding, pThreadPool))
+				return false;
+
+			mesh.primitiveTopology = PrimitiveTopology::TriangleList;
+			CalculateBounds(mesh.vertices, mesh.boundsMin, mesh.boundsMax);
+			CalculateBoundingSphere(mesh.vertices, mesh.boundsMin, mesh.boundsMax, mesh.boundsCenter, mesh.boundsRadius);
+			BuildVertexStreams(mesh.vertices, mesh.vertexStreams);
+
+			//a cache that can't be written only costs the next startup
+			SaveMeshCache(cacheFilename, mesh, flipAxisAndWinding);
+			return true;
+		}
 #pragma warning(pop)
 	}
 }
\ No newline at end of file
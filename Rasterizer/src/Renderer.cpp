@@ -4,8 +4,11 @@
 
 //Project includes
 #include "Renderer.h"
+#include "AllocationCounter.h"
+#include "MaterialTexture.h"
 #include "Maths.h"
 #include "Texture.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 #include <iostream>
 
@@ -23,21 +26,58 @@ Renderer::Renderer(SDL_Window* pWindow) :
 
 	//Create Buffers
 	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
-	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	const SDL_PixelFormat* pWindowFormat{ m_pFrontBuffer->format };
+	if (pWindowFormat->BytesPerPixel == 4 && pWindowFormat->Rloss == 0 && pWindowFormat->Gloss == 0 && pWindowFormat->Bloss == 0
+		&& m_pFrontBuffer->w == m_Width && m_pFrontBuffer->h == m_Height && m_pFrontBuffer->pitch == m_Width * 4 && !SDL_MUSTLOCK(m_pFrontBuffer))
+	{
+		m_pBackBuffer = m_pFrontBuffer;
+	}
+	else
+	{
+		//the blit converts to the window format
+		m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	}
 	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
 
+	//the pixels get packed without SDL_MapRGB
+	const SDL_PixelFormat* pFormat{ m_pBackBuffer->format };
+	m_PixelFormat = { pFormat->Rshift, pFormat->Gshift, pFormat->Bshift, pFormat->Amask };
+
 	m_pDepthBufferPixels = new float[m_Width * m_Height];
+	m_pVisibilityBufferPixels = new uint32_t[m_Width * m_Height];
+	m_CoarseDepthWidth = (m_Width + RASTER_BLOCK_SIZE - 1) / RASTER_BLOCK_SIZE;
+	m_pCoarseDepthBuffer = new float[m_CoarseDepthWidth * ((m_Height + RASTER_BLOCK_SIZE - 1) / RASTER_BLOCK_SIZE)];
+	m_ClearColour = SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100);
+
+	//pick the widest pixel pipeline this cpu supports
+	if (SDL_HasAVX2())
+	{
+		m_SimdMode = SimdMode::avx2Mode;
+	}
+	else if (SDL_HasSSE2())
+	{
+		m_SimdMode = SimdMode::sseMode;
+	}
+	else
+	{
+		m_SimdMode = SimdMode::scalarMode;
+	}
+
+	//Initialize Tiles
+	m_TileCountX = (m_Width + TILE_SIZE - 1) / TILE_SIZE;
+	m_TileCountY = (m_Height + TILE_SIZE - 1) / TILE_SIZE;
+	m_pThreadPool = new ThreadPool{};
+	m_pFrameArena = new FrameArena{};
 
-	//vehicle textures
-	m_pDiffuseTexture = Texture::LoadFromFile({ "Resources/vehicle_diffuse.png" } );
-	m_pGlossTexture = Texture::LoadFromFile({ "Resources/vehicle_gloss.png" } );
-	m_pNormalTexture = Texture::LoadFromFile({ "Resources/vehicle_normal.png" } );
-	m_pSpecularTexture = Texture::LoadFromFile({ "Resources/vehicle_specular.png" } );
+	//vehicle textures, BC1 bands the normals => they stay lossless
+	m_pMaterialTexture = MaterialTexture::LoadFromFiles("Resources/vehicle_diffuse.png", "Resources/vehicle_gloss.png", "Resources/vehicle_normal.png", "Resources/vehicle_specular.png", TexelLayout::Morton, MaterialFormat::CompressedLosslessNormals);
 
 	//make vehicle mesh
 	Mesh mesh{};
-	Utils::ParseOBJ("Resources/vehicle.obj", mesh.vertices, mesh.indices);
-	m_MeshesObject.emplace_back(mesh);
+	Utils::LoadMesh("Resources/vehicle.obj", mesh, true, m_pThreadPool);
+	//the vertex stage & clipping read the streams => no need to keep every vertex twice
+	std::vector<Vertex>{}.swap(mesh.vertices);
+	m_MeshesObject.emplace_back(std::move(mesh));
 
 	//initialize enum variables
 	m_RenderMode  = RenderMode::finalColour; 
@@ -46,11 +86,28 @@ Renderer::Renderer(SDL_Window* pWindow) :
 
 Renderer::~Renderer()
 {
-	delete m_pDiffuseTexture;
-	delete m_pGlossTexture;
-	delete m_pNormalTexture;
-	delete m_pSpecularTexture;
+	//the window surface belongs to the window
+	if (m_pBackBuffer != m_pFrontBuffer)
+	{
+		SDL_FreeSurface(m_pBackBuffer);
+	}
+
+	delete m_pMaterialTexture;
 	delete[] m_pDepthBufferPixels;
+	delete[] m_pVisibilityBufferPixels;
+	delete[] m_pCoarseDepthBuffer;
+	delete m_pThreadPool;
+
+	//the bins & clipped vertices live in the arenas => gone before the arenas are
+	std::vector<TileBin>{}.swap(m_TileBins);
+	std::vector<ClippedVertices>{}.swap(m_ClippedVertices);
+
+	//sub arenas first, they point in their parent
+	for (FrameArena* pArena : m_pBinningArenas)
+	{
+		delete pArena;
+	}
+	delete m_pFrameArena;
 }
 
 void Renderer::Update(Timer* pTimer)
@@ -65,6 +122,17 @@ void Renderer::Update(Timer* pTimer)
 
 void Renderer::Render()
 {
+	const uint64_t allocationCount{ AllocationCounter::GetCount() };
+
+	//nothing of last frame is used anymore, the containers go before their memory does
+	m_TileBins.clear();
+	m_ClippedVertices.clear();
+	m_pFrameArena->Reset();
+	for (FrameArena* pArena : m_pBinningArenas)
+	{
+		pArena->Reset();
+	}
+
 	//@START
 	//Lock BackBuffer
 	SDL_LockSurface(m_pBackBuffer);
@@ -82,64 +150,570 @@ void Renderer::Render()
 	//@END
 	//Update SDL Surface
 	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+	if (m_pBackBuffer != m_pFrontBuffer)
+	{
+		SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
+	}
 	SDL_UpdateWindowSurface(m_pWindow);
+
+	m_FrameAllocationCount = AllocationCounter::GetCount() - allocationCount;
 }
 
 void Renderer::RenderMesh_W4()
 {
+	//whole meshes outside the view are dropped before any of their vertices get touched
+	for (Mesh& mesh : m_MeshesObject)
+	{
+		mesh.isVisible = IsMeshInFrustum(mesh, mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix);
+	}
+
 	//from world to view to projection to screen space
 	VertexTransformationFunction(m_MeshesObject);
 
-	std::fill_n(m_pDepthBufferPixels, m_Width * m_Height, FLT_MAX);
+	//split every mesh in chunks of triangles, each chunk gets binned by one thread
+	m_BinningJobs.clear();
+	for (uint32_t meshIdx{}; meshIdx < m_MeshesObject.size(); ++meshIdx)
+	{
+		const Mesh& mesh{ m_MeshesObject[meshIdx] };
+		if (!mesh.isVisible)
+		{
+			continue;
+		}
 
-	//clear back buffer
-	SDL_FillRect(m_pBackBuffer, &m_pBackBuffer->clip_rect, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
+		//a triangle list moves 3 indices per triangle, a strip only 1
+		const bool isTriangleStrip{ mesh.primitiveTopology == PrimitiveTopology::TriangleStrip };
+		const uint32_t indexStep{ isTriangleStrip ? 1u : 3u };
+		const uint32_t maxIdx{ isTriangleStrip ? static_cast<uint32_t>(std::max(mesh.indices.size(), size_t{ 2 }) - 2) : static_cast<uint32_t>(mesh.indices.size()) };
 
-	for (Mesh mesh : m_MeshesObject)
+		for (uint32_t firstIdx{}; firstIdx < maxIdx; firstIdx += BINNING_JOB_TRIANGLES * indexStep)
+		{
+			m_BinningJobs.push_back({ meshIdx, firstIdx, std::min(firstIdx + BINNING_JOB_TRIANGLES * indexStep, maxIdx) });
+		}
+	}
+
+	while (m_pBinningArenas.size() < m_BinningJobs.size())
 	{
-		if (mesh.primitiveTopology == PrimitiveTopology::TriangleStrip)
+		m_pBinningArenas.push_back(new FrameArena{ *m_pFrameArena });
+	}
+
+	//this frame's bins & clipped vertices, every binning job's in its own sub arena
+	const uint32_t tileCount{ static_cast<uint32_t>(m_TileCountX * m_TileCountY) };
+	m_TileBins.reserve(m_BinningJobs.size() * tileCount);
+	m_ClippedVertices.reserve(m_BinningJobs.size());
+	for (uint32_t binningJobIdx{}; binningJobIdx < m_BinningJobs.size(); ++binningJobIdx)
+	{
+		FrameArena& arena{ *m_pBinningArenas[binningJobIdx] };
+		for (uint32_t tileIdx{}; tileIdx < tileCount; ++tileIdx)
 		{
-			//extra variable; amount of sides : 0, 1, 2
-			const auto& maxIdx{ mesh.indices.size() - 2 };
+			m_TileBins.emplace_back(FrameAllocator<BinnedTriangle>{ arena });
+		}
+		m_ClippedVertices.emplace_back(FrameAllocator<Vertex_Out>{ arena });
+	}
+
+	//sort triangles into the tiles they overlap
+	m_pThreadPool->ParallelFor(static_cast<uint32_t>(m_BinningJobs.size()), [this](uint32_t binningJobIdx) { BinTriangles(binningJobIdx); });
+
+	//the modes can only change between frames
+	SelectPixelPipeline();
+
+	//every tile owns its part of the back & depth buffer => no locking needed
+	m_pThreadPool->ParallelFor(tileCount, [this](uint32_t tileIdx) { RenderTile(tileIdx); });
+}
+
+void Renderer::BinTriangles(uint32_t binningJobIdx)
+{
+	const BinningJob& job{ m_BinningJobs[binningJobIdx] };
+	const Mesh& mesh{ m_MeshesObject[job.meshIdx] };
+	const uint32_t tileCount{ static_cast<uint32_t>(m_TileCountX * m_TileCountY) };
+	const uint32_t indexStep{ mesh.primitiveTopology == PrimitiveTopology::TriangleStrip ? 1u : 3u };
+
+	TileBin* pBins{ &m_TileBins[binningJobIdx * tileCount] };
+	ClippedVertices& clippedVertices{ m_ClippedVertices[binningJobIdx] };
+
+	const Vertex_Out* pTransformedVertices{ GetTransformedVertices(job.meshIdx) };
+
+	//only needed to bring the vertices of clipped triangles back to clip space
+	const Matrix worldViewProjectionMatrix{ mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+
+	for (uint32_t triangleIdx{ job.firstTriangleIdx }; triangleIdx < job.lastTriangleIdx; triangleIdx += indexStep)
+	{
+		uint32_t indices[3]{};
+		GetTriangleIndices(mesh, triangleIdx, indices);
+
+		const Vector4& p0{ pTransformedVertices[indices[0]].position };
+		const Vector4& p1{ pTransformedVertices[indices[1]].position };
+		const Vector4& p2{ pTransformedVertices[indices[2]].position };
+
+		const uint8_t outCode0{ ComputeOutCode(p0) };
+		const uint8_t outCode1{ ComputeOutCode(p1) };
+		const uint8_t outCode2{ ComputeOutCode(p2) };
 
-			//go over triangle, per 3 vertices
-			for (int triangleIdx{}; triangleIdx < maxIdx; ++triangleIdx)
+		//frustum culling, every vertex is outside the same plane
+		if ((outCode0 & outCode1 & outCode2) != insideCode)
+		{
+			continue;
+		}
+
+		//in front of the camera & inside the guard band => clamping the bounding box is enough
+		if (((outCode0 | outCode1 | outCode2) & (nearCode | guardBandCode)) == insideCode)
+		{
+			BinTriangle(pBins, p0, p1, p2, { job.meshIdx, triangleIdx }, mesh.cullMode);
+			continue;
+		}
+
+		const uint32_t firstClippedIdx{ static_cast<uint32_t>(clippedVertices.size()) };
+		ClipTriangle(worldViewProjectionMatrix, mesh, pTransformedVertices, indices, clippedVertices);
+
+		for (uint32_t clippedIdx{ firstClippedIdx }; clippedIdx < clippedVertices.size(); clippedIdx += 3)
+		{
+			BinTriangle(pBins, clippedVertices[clippedIdx + 0].position, clippedVertices[clippedIdx + 1].position, clippedVertices[clippedIdx + 2].position, { CLIPPED_MESH_IDX, clippedIdx }, mesh.cullMode);
+		}
+	}
+}
+
+void Renderer::BinTriangle(TileBin* pBins, const Vector4& p0, const Vector4& p1, const Vector4& p2, const BinnedTriangle& triangle, CullMode cullMode) const
+{
+	//twice the signed area, clipping keeps the winding so clipped triangles cull the same way
+	const float signedArea{ Vector2::Cross(p1.GetXY() - p0.GetXY(), p2.GetXY() - p0.GetXY()) };
+	const bool isFrontFace{ signedArea > 0.f };
+	const bool isBackFace{ signedArea < 0.f };
+
+	//degenerate triangles (and NaN) are neither
+	if ((!isFrontFace && !isBackFace) || (cullMode == CullMode::Back && isBackFace) || (cullMode == CullMode::Front && isFrontFace))
+	{
+		return;
+	}
+
+	//same bounding box TriangleHandeling scans, clamped to screen
+	const int minX{ Clamp(static_cast<int>(std::ceil(std::min({ p0.x, p1.x, p2.x }) - 0.5f)), 0, m_Width) };
+	const int minY{ Clamp(static_cast<int>(std::ceil(std::min({ p0.y, p1.y, p2.y }) - 0.5f)), 0, m_Height) };
+	const int maxX{ Clamp(static_cast<int>(std::floor(std::max({ p0.x, p1.x, p2.x }) - 0.5f)) + 1, 0, m_Width) };
+	const int maxY{ Clamp(static_cast<int>(std::floor(std::max({ p0.y, p1.y, p2.y }) - 0.5f)) + 1, 0, m_Height) };
+
+	//no pixel center in the bounding box => sub pixel triangle or off screen
+	if (minX >= maxX || minY >= maxY)
+	{
+		return;
+	}
+
+	for (int tileY{ minY / TILE_SIZE }; tileY <= (maxY - 1) / TILE_SIZE; ++tileY)
+	{
+		for (int tileX{ minX / TILE_SIZE }; tileX <= (maxX - 1) / TILE_SIZE; ++tileX)
+		{
+			pBins[tileX + (tileY * m_TileCountX)].push_back(triangle);
+		}
+	}
+}
+
+void Renderer::GetTriangleIndices(const Mesh& mesh, uint32_t triangleIdx, uint32_t indices[3]) const
+{
+	indices[0] = mesh.indices[triangleIdx + 0];
+	indices[1] = mesh.indices[triangleIdx + 1];
+	indices[2] = mesh.indices[triangleIdx + 2];
+
+	//if it's odd (oneven)
+	if (triangleIdx & 1 and mesh.primitiveTopology == PrimitiveTopology::TriangleStrip)
+	{
+		//swap variables, make triangle counter-clockwise
+		std::swap(indices[1], indices[2]);
+	}
+}
+
+uint8_t Renderer::ComputeOutCode(const Vector4& position) const
+{
+	//behind the near plane the divided position means nothing, w <= 0 (=> 1 / w <= 0) ends up here as well
+	if (!(position.w > 0.f && position.z >= 0.f))
+	{
+		return nearCode;
+	}
+
+	uint8_t outCode{ insideCode };
+	if (position.z > 1.f) outCode |= farCode;
+	if (position.x < 0.f) outCode |= leftCode;
+	if (position.x > m_Width) outCode |= rightCode;
+	if (position.y < 0.f) outCode |= topCode;
+	if (position.y > m_Height) outCode |= bottomCode;
+
+	//guard band in screen space, [-GUARD_BAND_SCALE, GUARD_BAND_SCALE] in NDC
+	const float guardBandMinX{ (1.f - GUARD_BAND_SCALE) / 2.f * m_Width };
+	const float guardBandMaxX{ (1.f + GUARD_BAND_SCALE) / 2.f * m_Width };
+	const float guardBandMinY{ (1.f - GUARD_BAND_SCALE) / 2.f * m_Height };
+	const float guardBandMaxY{ (1.f + GUARD_BAND_SCALE) / 2.f * m_Height };
+	if (position.x < guardBandMinX || position.x > guardBandMaxX || position.y < guardBandMinY || position.y > guardBandMaxY)
+	{
+		outCode |= guardBandCode;
+	}
+
+	return outCode;
+}
+
+void Renderer::ClipTriangle(const Matrix& worldViewProjectionMatrix, const Mesh& mesh, const Vertex_Out* pTransformedVertices, const uint32_t indices[3], ClippedVertices& clippedVertices) const
+{
+	//Sutherland-Hodgman, ping-ponging between two polygons on the stack
+	Vertex_Out polygons[2][MAX_CLIPPED_VERTICES]{};
+	int vertexCount{ 3 };
+
+	//attributes are linear in clip space => interpolate them before the perspective divide
+	const VertexStreams& streams{ mesh.vertexStreams };
+	for (int vertexIdx{}; vertexIdx < 3; ++vertexIdx)
+	{
+		polygons[0][vertexIdx] = pTransformedVertices[indices[vertexIdx]];
+		const Vector3 position{ streams.positionX[indices[vertexIdx]], streams.positionY[indices[vertexIdx]], streams.positionZ[indices[vertexIdx]] };
+		polygons[0][vertexIdx].position = worldViewProjectionMatrix.TransformPoint(Vector4{ position, 1.f });
+	}
+
+	//signed distance to the near plane (z >= 0) & the guard band planes (|x|, |y| <= GUARD_BAND_SCALE * w)
+	const auto planeDistance{ [](const Vector4& position, int planeIdx)
+		{
+			switch (planeIdx)
 			{
-				TriangleHandeling(triangleIdx, mesh);
+			case 0: return position.z;
+			case 1: return position.x + GUARD_BAND_SCALE * position.w;
+			case 2: return GUARD_BAND_SCALE * position.w - position.x;
+			case 3: return position.y + GUARD_BAND_SCALE * position.w;
+			default: return GUARD_BAND_SCALE * position.w - position.y;
 			}
-		}
-		else if (mesh.primitiveTopology == PrimitiveTopology::TriangleList)
+		} };
+
+	constexpr int planeCount{ MAX_CLIPPED_VERTICES - 3 };
+	for (int planeIdx{}; planeIdx < planeCount; ++planeIdx)
+	{
+		const Vertex_Out* pInput{ polygons[planeIdx % 2] };
+		Vertex_Out* pOutput{ polygons[(planeIdx + 1) % 2] };
+		int outputCount{};
+
+		for (int vertexIdx{}; vertexIdx < vertexCount; ++vertexIdx)
 		{
-			//go over triangle, per 3 vertices
-			for (int triangleIdx{}; triangleIdx < mesh.indices.size(); triangleIdx += 3)
+			const Vertex_Out& current{ pInput[vertexIdx] };
+			const Vertex_Out& next{ pInput[(vertexIdx + 1) % vertexCount] };
+			const float currentDistance{ planeDistance(current.position, planeIdx) };
+			const float nextDistance{ planeDistance(next.position, planeIdx) };
+
+			if (currentDistance >= 0.f)
 			{
-				TriangleHandeling(triangleIdx, mesh);
+				pOutput[outputCount++] = current;
 			}
+
+			//edge crosses the plane => add the intersection
+			if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+			{
+				pOutput[outputCount++] = LerpVertex(current, next, currentDistance / (currentDistance - nextDistance));
+			}
+		}
+
+		vertexCount = outputCount;
+		if (vertexCount < 3)
+		{
+			return;
 		}
 	}
+
+	Vertex_Out* pPolygon{ polygons[planeCount % 2] };
+	for (int vertexIdx{}; vertexIdx < vertexCount; ++vertexIdx)
+	{
+		pPolygon[vertexIdx].position = ProjectToScreen(pPolygon[vertexIdx].position);
+	}
+
+	//polygon is convex & keeps the winding of the triangle => fan around the first vertex
+	for (int vertexIdx{ 1 }; vertexIdx + 1 < vertexCount; ++vertexIdx)
+	{
+		clippedVertices.push_back(pPolygon[0]);
+		clippedVertices.push_back(pPolygon[vertexIdx]);
+		clippedVertices.push_back(pPolygon[vertexIdx + 1]);
+	}
 }
 
-void Renderer::TriangleHandeling(int triangleIdx, const Mesh& mesh_transformed)
-{	
-	//calculate bounding box for the current triangle in screen space
-	const Vertex_Out v0{ mesh_transformed.vertices_out[mesh_transformed.indices[triangleIdx + 0]] };
-	Vertex_Out v1{ mesh_transformed.vertices_out[mesh_transformed.indices[triangleIdx + 1]] };
-	Vertex_Out v2{ mesh_transformed.vertices_out[mesh_transformed.indices[triangleIdx + 2]] };
+Vertex_Out Renderer::LerpVertex(const Vertex_Out& v0, const Vertex_Out& v1, float factor)
+{
+	Vertex_Out vertex{};
+	vertex.position = v0.position + (v1.position - v0.position) * factor;
+	vertex.uv = v0.uv + (v1.uv - v0.uv) * factor;
+
+	//unit vectors get lerped decoded, only the direction survives encoding
+	const Vector3 normal0{ DecodeUnitVector(v0.normal) };
+	const Vector3 tangent0{ DecodeUnitVector(v0.tangent) };
+	vertex.normal = EncodeUnitVector(normal0 + (DecodeUnitVector(v1.normal) - normal0) * factor);
+	vertex.tangent = EncodeUnitVector(tangent0 + (DecodeUnitVector(v1.tangent) - tangent0) * factor);
+	vertex.viewDirection = v0.viewDirection + (v1.viewDirection - v0.viewDirection) * factor;
+	return vertex;
+}
 
-	//if it's odd (oneven)
-	if (triangleIdx & 1 and mesh_transformed.primitiveTopology == PrimitiveTopology::TriangleStrip)
+bool Renderer::IsMeshInFrustum(const Mesh& mesh, const Matrix& worldViewProjectionMatrix) const
+{
+	//clip space x = dot(position, column 0) etc. => -w <= x, y <= w & 0 <= z <= w are 6 planes ax + by + cz + d >= 0 in object space
+	const Vector4 columnX{ worldViewProjectionMatrix[0].x, worldViewProjectionMatrix[1].x, worldViewProjectionMatrix[2].x, worldViewProjectionMatrix[3].x };
+	const Vector4 columnY{ worldViewProjectionMatrix[0].y, worldViewProjectionMatrix[1].y, worldViewProjectionMatrix[2].y, worldViewProjectionMatrix[3].y };
+	const Vector4 columnZ{ worldViewProjectionMatrix[0].z, worldViewProjectionMatrix[1].z, worldViewProjectionMatrix[2].z, worldViewProjectionMatrix[3].z };
+	const Vector4 columnW{ worldViewProjectionMatrix[0].w, worldViewProjectionMatrix[1].w, worldViewProjectionMatrix[2].w, worldViewProjectionMatrix[3].w };
+	const Vector4 planes[6]{ columnW + columnX, columnW - columnX, columnW + columnY, columnW - columnY, columnZ, columnW - columnZ };
+
+	bool isSphereInside{ true };
+	for (const Vector4& plane : planes)
 	{
-		//swap variables, make triangle counter-clockwise
-		v1 = { mesh_transformed.vertices_out[mesh_transformed.indices[triangleIdx + 2]] };
-		v2 = { mesh_transformed.vertices_out[mesh_transformed.indices[triangleIdx + 1]] };
+		const Vector3 normal{ plane.GetXYZ() };
+		const float normalLength{ normal.Magnitude() };
+		const float distance{ Vector3::Dot(normal, mesh.boundsCenter) + plane.w };
+
+		//distance is scaled by the length of the normal
+		if (distance < -mesh.boundsRadius * normalLength)
+		{
+			return false;
+		}
+		isSphereInside &= distance >= mesh.boundsRadius * normalLength;
+	}
+
+	if (isSphereInside)
+	{
+		return true;
+	}
+
+	//the corner farthest along the normal, when even that one is outside the whole box is
+	for (const Vector4& plane : planes)
+	{
+		const Vector3 corner{ plane.x >= 0.f ? mesh.boundsMax.x : mesh.boundsMin.x, plane.y >= 0.f ? mesh.boundsMax.y : mesh.boundsMin.y, plane.z >= 0.f ? mesh.boundsMax.z : mesh.boundsMin.z };
+		if (Vector3::Dot(plane.GetXYZ(), corner) + plane.w < 0.f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Vector4 Renderer::ProjectToScreen(const Vector4& clipPosition) const
+{
+	//model to NDC space, 1 / w stays for the perspective correct interpolation
+	const float invW{ 1.f / clipPosition.w };
+	Vector4 screenPosition{ clipPosition.x * invW, clipPosition.y * invW, clipPosition.z * invW, invW };
+
+	//projection to screen space
+	screenPosition.x = ((screenPosition.x + 1.f) / 2.f) * m_Width;
+	screenPosition.y = ((1.f - screenPosition.y) / 2.f) * m_Height;
+
+	return screenPosition;
+}
+
+void Renderer::RenderTile(uint32_t tileIdx)
+{
+	const Int2 tileMin{ static_cast<int>(tileIdx % m_TileCountX) * TILE_SIZE, static_cast<int>(tileIdx / m_TileCountX) * TILE_SIZE };
+	const Int2 tileMax{ std::min(tileMin.x + TILE_SIZE, m_Width), std::min(tileMin.y + TILE_SIZE, m_Height) };
+
+	//clear this tile of the depth & back buffer
+	for (int py{ tileMin.y }; py < tileMax.y; ++py)
+	{
+		const int rowStartIdx{ tileMin.x + (py * m_Width) };
+		std::fill_n(m_pDepthBufferPixels + rowStartIdx, tileMax.x - tileMin.x, FLT_MAX);
+		std::fill_n(m_pBackBufferPixels + rowStartIdx, tileMax.x - tileMin.x, m_ClearColour);
+
+		if (m_PassMode == Renderer::visibilityBuffer)
+		{
+			std::fill_n(m_pVisibilityBufferPixels + rowStartIdx, tileMax.x - tileMin.x, EMPTY_VISIBILITY_ID);
+		}
+	}
+
+	//tiles are a multiple of the raster block size => every block is in one tile
+	for (int blockY{ tileMin.y / RASTER_BLOCK_SIZE }; blockY * RASTER_BLOCK_SIZE < tileMax.y; ++blockY)
+	{
+		const int blockStartIdx{ (tileMin.x / RASTER_BLOCK_SIZE) + (blockY * m_CoarseDepthWidth) };
+		std::fill_n(m_pCoarseDepthBuffer + blockStartIdx, (tileMax.x - tileMin.x + RASTER_BLOCK_SIZE - 1) / RASTER_BLOCK_SIZE, FLT_MAX);
+	}
+
+	//pixel pipeline of the modes of this frame
+	(this->*m_pRasterizeTile)(tileIdx, tileMin, tileMax);
+
+	if (m_pShadeTile)
+	{
+		(this->*m_pShadeTile)(tileIdx, tileMin, tileMax);
+	}
+}
+
+void Renderer::SelectPixelPipeline()
+{
+	switch (m_SimdMode)
+	{
+	case Renderer::sseMode:
+		SelectPixelPipeline<Simd::SseFloat4>();
+		break;
+	case Renderer::avx2Mode:
+		SelectPixelPipeline<Simd::AvxFloat8>();
+		break;
+	default:
+		SelectPixelPipeline<Simd::ScalarFloat4>();
+		break;
 	}
+}
 
-	//frustum culling
-	if (v0.position.x < 0 || v0.position.x > m_Width || v0.position.y < 0 || v0.position.y > m_Height || 
-		v1.position.x < 0 || v1.position.x > m_Width || v1.position.y < 0 || v1.position.y > m_Height || 
-		v2.position.x < 0 || v2.position.x > m_Width || v2.position.y < 0 || v2.position.y > m_Height) 
+template<typename Float>
+void Renderer::SelectPixelPipeline()
+{
+	//the depth buffer doesn't shade => the shading modes don't matter
+	if (m_RenderMode == Renderer::depthBuffer)
 	{
+		UsePixelPipeline<Float, PixelPipeline<depthBuffer, observedArea, false>>();
+		return;
+	}
+
+	switch (m_ShadingMode)
+	{
+	case Renderer::observedArea:
+		SelectPixelPipeline<Float, observedArea>();
+		break;
+	case Renderer::diffuseMode:
+		SelectPixelPipeline<Float, diffuseMode>();
+		break;
+	case Renderer::specularMode:
+		SelectPixelPipeline<Float, specularMode>();
+		break;
+	default:
+		SelectPixelPipeline<Float, combinedMode>();
+		break;
+	}
+}
+
+template<typename Float, Renderer::ShadingMode shadingMode>
+void Renderer::SelectPixelPipeline()
+{
+	if (m_IsShowingNormalMap)
+	{
+		UsePixelPipeline<Float, PixelPipeline<finalColour, shadingMode, true>>();
+		return;
+	}
+	UsePixelPipeline<Float, PixelPipeline<finalColour, shadingMode, false>>();
+}
+
+template<typename Float, typename Pipeline>
+void Renderer::UsePixelPipeline()
+{
+	//showing the depth buffer doesn't shade, nothing to save
+	const PassMode passMode{ (Pipeline::RENDER_MODE == Renderer::finalColour) ? m_PassMode : Renderer::singlePass };
+
+	switch (passMode)
+	{
+	case Renderer::depthPrePass:
+		m_pRasterizeTile = &Renderer::RasterizeTile<Float, DepthPipeline<false>>;
+		m_pShadeTile = &Renderer::RasterizeTile<Float, EqualDepthPipeline<Pipeline>>;
+		break;
+	case Renderer::visibilityBuffer:
+		m_pRasterizeTile = &Renderer::RasterizeTile<Float, DepthPipeline<true>>;
+		m_pShadeTile = &Renderer::ShadeTile<Float, Pipeline>;
+		break;
+	default:
+		m_pRasterizeTile = &Renderer::RasterizeTile<Float, Pipeline>;
+		m_pShadeTile = nullptr;
+		break;
+	}
+}
+
+template<typename Float, typename Pipeline>
+void Renderer::RasterizeTile(uint32_t tileIdx, const Int2& tileMin, const Int2& tileMax)
+{
+	const uint32_t tileCount{ static_cast<uint32_t>(m_TileCountX * m_TileCountY) };
+
+	//binning jobs are in submission order => triangles get drawn in the same order as before
+	for (uint32_t binningJobIdx{}; binningJobIdx < m_BinningJobs.size(); ++binningJobIdx)
+	{
+		const TileBin& bin{ m_TileBins[(binningJobIdx * tileCount) + tileIdx] };
+		for (uint32_t binIdx{}; binIdx < bin.size(); ++binIdx)
+		{
+			const Vertex_Out* pVertices[3]{};
+			GetBinnedVertices(binningJobIdx, bin[binIdx], pVertices);
+			TriangleHandeling<Float, Pipeline>(*pVertices[0], *pVertices[1], *pVertices[2], tileMin, tileMax, (binningJobIdx << VISIBILITY_BIN_BITS) | binIdx);
+		}
+	}
+}
+
+void Renderer::GetBinnedVertices(uint32_t binningJobIdx, const BinnedTriangle& triangle, const Vertex_Out* pVertices[3]) const
+{
+	if (triangle.meshIdx == CLIPPED_MESH_IDX)
+	{
+		const Vertex_Out* pClippedVertices{ &m_ClippedVertices[binningJobIdx][triangle.triangleIdx] };
+		pVertices[0] = &pClippedVertices[0];
+		pVertices[1] = &pClippedVertices[1];
+		pVertices[2] = &pClippedVertices[2];
+		return;
+	}
+
+	const Vertex_Out* pTransformedVertices{ GetTransformedVertices(triangle.meshIdx) };
+	uint32_t indices[3]{};
+	GetTriangleIndices(m_MeshesObject[triangle.meshIdx], triangle.triangleIdx, indices);
+	pVertices[0] = &pTransformedVertices[indices[0]];
+	pVertices[1] = &pTransformedVertices[indices[1]];
+	pVertices[2] = &pTransformedVertices[indices[2]];
+}
+
+template<typename Float, typename Pipeline>
+void Renderer::ShadeTile(uint32_t tileIdx, const Int2& tileMin, const Int2& tileMax)
+{
+	constexpr int blockWidth{ Float::BlockWidth };
+	const uint32_t tileCount{ static_cast<uint32_t>(m_TileCountX * m_TileCountY) };
+
+	//neighbouring blocks mostly show the same triangle => only set it up again when it changes
+	TriangleSetup triangle{};
+	triangle.visibilityId = EMPTY_VISIBILITY_ID;
+
+	for (int py{ tileMin.y }; py < tileMax.y; py += 2)
+	{
+		for (int px{ tileMin.x }; px < tileMax.x; px += blockWidth)
+		{
+			//lanes past the right or bottom edge of the tile are empty
+			uint32_t visibilityIds[Float::Width]{};
+			int remainingMask{};
+			for (int lane{}; lane < Float::Width; ++lane)
+			{
+				const int x{ px + (lane % blockWidth) };
+				const int y{ py + (lane / blockWidth) };
+
+				visibilityIds[lane] = (x < tileMax.x && y < tileMax.y) ? m_pVisibilityBufferPixels[x + (y * m_Width)] : EMPTY_VISIBILITY_ID;
+				if (visibilityIds[lane] != EMPTY_VISIBILITY_ID)
+				{
+					remainingMask |= 1 << lane;
+				}
+			}
+
+			//shade the lanes of one triangle at a time
+			while (remainingMask != 0)
+			{
+				int firstLane{};
+				while ((remainingMask & (1 << firstLane)) == 0)
+				{
+					++firstLane;
+				}
+
+				const uint32_t visibilityId{ visibilityIds[firstLane] };
+				int laneMask{};
+				for (int lane{ firstLane }; lane < Float::Width; ++lane)
+				{
+					if (visibilityIds[lane] == visibilityId)
+					{
+						laneMask |= 1 << lane;
+					}
+				}
+				remainingMask &= ~laneMask;
+
+				if (visibilityId != triangle.visibilityId)
+				{
+					const uint32_t binningJobIdx{ visibilityId >> VISIBILITY_BIN_BITS };
+					const BinnedTriangle& binnedTriangle{ m_TileBins[(binningJobIdx * tileCount) + tileIdx][visibilityId & ((1u << VISIBILITY_BIN_BITS) - 1)] };
+					const Vertex_Out* pVertices[3]{};
+					GetBinnedVertices(binningJobIdx, binnedTriangle, pVertices);
+					triangle = SetupTriangle(*pVertices[0], *pVertices[1], *pVertices[2], visibilityId);
+					SetupAttributePlanes<Pipeline>(triangle);
+				}
+
+				//the planes get evaluated on every lane => the quads still have their uv derivatives
+				ShadePixels<Float, Pipeline>(triangle, Float{}, laneMask, px, py);
+			}
+		}
+	}
+}
+
+template<typename Float, typename Pipeline>
+void Renderer::TriangleHandeling(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Int2& tileMin, const Int2& tileMax, uint32_t visibilityId)
+{	
+	//back faces that weren't culled get drawn as front faces => edge functions are positive inside
+	if (Vector2::Cross(v1.position.GetXY() - v0.position.GetXY(), v2.position.GetXY() - v0.position.GetXY()) < 0.f)
+	{
+		TriangleHandeling<Float, Pipeline>(v0, v2, v1, tileMin, tileMax, visibilityId);
 		return;
 	}
 
@@ -148,298 +722,729 @@ void Renderer::TriangleHandeling(int triangleIdx, const Mesh& mesh_transformed)
 	const Vector2 v0_v2{ v0.position.GetXY() - v2.position.GetXY() }; 
 	const Vector2 v1_v0{ v1.position.GetXY() - v0.position.GetXY() };
 
-	//scale to increase bounding box size -> no lines between triangles/quads
-	const float boundingBoxScale{ 5.f }; 
+	//edge equations, w(x + 1, y) = w(x, y) + stepX and w(x, y + 1) = w(x, y) + stepY
+	const float stepX[3]{ -v2_v1.y, -v0_v2.y, -v1_v0.y };
+	const float stepY[3]{ v2_v1.x, v0_v2.x, v1_v0.x };
 
-	//calculate min & max x of bounding box, clamped to screen
-	const float topLeftX{ std::min({v0.position.x, v1.position.x, v2.position.x}) }; 
-	const float topLeftY{ std::min({v0.position.y, v1.position.y, v2.position.y}) }; 
-	const int minX{ Clamp(static_cast<int>(topLeftX - boundingBoxScale), 0, m_Width) }; 
-	const int minY{ Clamp(static_cast<int>(topLeftY - boundingBoxScale), 0, m_Height) }; 
+	TriangleSetup triangle{ SetupTriangle(v0, v1, v2, visibilityId) };
 
-	//calculate min & max y of bounding box, clamped to screen
-	const float bottomRightX{ std::max({v0.position.x, v1.position.x, v2.position.x}) }; 
-	const float bottomRightY{ std::max({v0.position.y, v1.position.y, v2.position.y}) }; 
-	const int maxX{ Clamp(static_cast<int>(bottomRightX + boundingBoxScale), 0, m_Width) }; 
-	const int maxY{ Clamp(static_cast<int>(bottomRightY + boundingBoxScale), 0, m_Height) }; 
+	//calculate bounding box, clamped to the tile
+	//pixel centers sit at +0.5 => only pixels with their center between the vertices can be covered
+	const int minX{ Clamp(static_cast<int>(std::ceil(std::min({ v0.position.x, v1.position.x, v2.position.x }) - 0.5f)), tileMin.x, tileMax.x) };
+	const int minY{ Clamp(static_cast<int>(std::ceil(std::min({ v0.position.y, v1.position.y, v2.position.y }) - 0.5f)), tileMin.y, tileMax.y) };
+	const int maxX{ Clamp(static_cast<int>(std::floor(std::max({ v0.position.x, v1.position.x, v2.position.x }) - 0.5f)) + 1, tileMin.x, tileMax.x) };
+	const int maxY{ Clamp(static_cast<int>(std::floor(std::max({ v0.position.y, v1.position.y, v2.position.y }) - 0.5f)) + 1, tileMin.y, tileMax.y) };
 
-	//go over each pixel is in screen space
-	for (int px{ minX }; px < maxX; ++px)
+	//NDC depth is linear in screen space => the nearest depth of the triangle is at a vertex
+	const float minDepth{ std::min({ triangle.depths[0], triangle.depths[1], triangle.depths[2] }) - COARSE_DEPTH_EPSILON };
+
+	//behind everything drawn in its bounding box => skip the whole triangle
+	bool isHidden{ true };
+	for (int blockY{ minY / RASTER_BLOCK_SIZE }; isHidden && blockY * RASTER_BLOCK_SIZE < maxY; ++blockY)
 	{
-		for (int py{ minY }; py < maxY; ++py)
+		for (int blockX{ minX / RASTER_BLOCK_SIZE }; blockX * RASTER_BLOCK_SIZE < maxX; ++blockX)
 		{
-			//define current pixel in screen space
-			const Vector2 p{ px + 0.5f, py + 0.5f };
+			if (minDepth <= m_pCoarseDepthBuffer[blockX + (blockY * m_CoarseDepthWidth)])
+			{
+				isHidden = false;
+				break;
+			}
+		}
+	}
 
-			float w0{ Vector2::Cross(v2_v1, p - v1.position.GetXY()) };
-			float w1{ Vector2::Cross(v0_v2, p - v2.position.GetXY()) };
-			float w2{ Vector2::Cross(v1_v0, p - v0.position.GetXY()) };
+	if (isHidden)
+	{
+		return;
+	}
+
+	if constexpr (Pipeline::IS_SHADING)
+	{
+		SetupAttributePlanes<Pipeline>(triangle);
+	}
+
+	//depth plane, z(x + 1, y) = z(x, y) + depthStepX and z(x, y + 1) = z(x, y) + depthStepY
+	const float depthStepX{ (stepX[0] * triangle.depths[0] + stepX[1] * triangle.depths[1] + stepX[2] * triangle.depths[2]) * triangle.invTriangleArea };
+	const float depthStepY{ (stepY[0] * triangle.depths[0] + stepY[1] * triangle.depths[1] + stepY[2] * triangle.depths[2]) * triangle.invTriangleArea };
 
-			if (w0 >= 0.f && w1 >= 0.f && w2 >= 0.f)
+	//every lane steps the edge functions by its own offset in the SIMD block
+	constexpr int blockWidth{ Float::BlockWidth };
+	const Float laneX{ Float::LaneX() };
+	const Float laneY{ Float::LaneY() };
+	const Float laneW[3]
+	{
+		laneX * stepX[0] + laneY * stepY[0],
+		laneX * stepX[1] + laneY * stepY[1],
+		laneX * stepX[2] + laneY * stepY[2]
+	};
+	const Float allLanes{ Float{ 0.f } <= 0.f };
+
+	//go over the bounding box in blocks, row by row
+	for (int blockY{ minY - (minY % RASTER_BLOCK_SIZE) }; blockY < maxY; blockY += RASTER_BLOCK_SIZE)
+	{
+		//rows of the block inside the bounding box, widened to whole SIMD blocks
+		int startY{ std::max(blockY, minY) };
+		int endY{ std::min(blockY + RASTER_BLOCK_SIZE, maxY) };
+		startY -= startY % 2;
+		endY += endY % 2;
+
+		for (int blockX{ minX - (minX % RASTER_BLOCK_SIZE) }; blockX < maxX; blockX += RASTER_BLOCK_SIZE)
+		{
+			int startX{ std::max(blockX, minX) };
+			int endX{ std::min(blockX + RASTER_BLOCK_SIZE, maxX) };
+			startX -= startX % blockWidth;
+			endX += (blockWidth - (endX % blockWidth)) % blockWidth;
+
+			//edge values at the center of the first pixel of the block
+			const Vector2 p{ startX + 0.5f, startY + 0.5f };
+			float rowW[3]
 			{
-				ProcessRenderedTriangle(v0, v1, v2, w0, w1, w2, px, py);
+				Vector2::Cross(v2_v1, p - v1.position.GetXY()),
+				Vector2::Cross(v0_v2, p - v2.position.GetXY()),
+				Vector2::Cross(v1_v0, p - v0.position.GetXY())
+			};
+
+			//an edge function is linear => its extremes over the block are in the corners
+			bool isBlockOutside{ false };
+			bool isBlockInside{ true };
+			for (int edgeIdx{}; edgeIdx < 3; ++edgeIdx)
+			{
+				const float blockStepX{ stepX[edgeIdx] * (endX - 1 - startX) };
+				const float blockStepY{ stepY[edgeIdx] * (endY - 1 - startY) };
+
+				if (rowW[edgeIdx] + std::max(blockStepX, 0.f) + std::max(blockStepY, 0.f) < 0.f)
+				{
+					isBlockOutside = true;
+				}
+				if (rowW[edgeIdx] + std::min(blockStepX, 0.f) + std::min(blockStepY, 0.f) < 0.f)
+				{
+					isBlockInside = false;
+				}
+			}
+
+			//reject the whole block at once
+			if (isBlockOutside)
+			{
+				continue;
+			}
+
+			//the depth plane is nearest in one of the corners, nothing in front of the block's max depth => hidden
+			const float cornerDepth{ (rowW[0] * triangle.depths[0] + rowW[1] * triangle.depths[1] + rowW[2] * triangle.depths[2]) * triangle.invTriangleArea };
+			const float blockMinDepth{ cornerDepth + std::min(depthStepX * (endX - 1 - startX), 0.f) + std::min(depthStepY * (endY - 1 - startY), 0.f) - COARSE_DEPTH_EPSILON };
+			if (std::max(minDepth, blockMinDepth) > m_pCoarseDepthBuffer[(blockX / RASTER_BLOCK_SIZE) + ((blockY / RASTER_BLOCK_SIZE) * m_CoarseDepthWidth)])
+			{
+				continue;
+			}
+
+			bool isDepthStored{ false };
+
+			for (int py{ startY }; py < endY; py += 2)
+			{
+				Float w0{ laneW[0] + rowW[0] };
+				Float w1{ laneW[1] + rowW[1] };
+				Float w2{ laneW[2] + rowW[2] };
+
+				for (int px{ startX }; px < endX; px += blockWidth)
+				{
+					//a block fully inside the triangle needs no per pixel test
+					Float mask{ isBlockInside ? allLanes : (w0 >= 0.f) & (w1 >= 0.f) & (w2 >= 0.f) };
+
+					//drop the lanes past the right or bottom edge of the tile
+					if (px + blockWidth > tileMax.x || py + 2 > tileMax.y)
+					{
+						mask = mask & (laneX + static_cast<float>(px) < static_cast<float>(tileMax.x)) & (laneY + static_cast<float>(py) < static_cast<float>(tileMax.y));
+					}
+
+					if (mask.MoveMask() != 0)
+					{
+						isDepthStored |= ProcessRenderedTriangle<Float, Pipeline>(triangle, w0, w1, w2, mask, px, py);
+					}
+
+					w0 += stepX[0] * blockWidth;
+					w1 += stepX[1] * blockWidth;
+					w2 += stepX[2] * blockWidth;
+				}
+
+				rowW[0] += stepY[0] * 2.f;
+				rowW[1] += stepY[1] * 2.f;
+				rowW[2] += stepY[2] * 2.f;
+			}
+
+			if (isDepthStored)
+			{
+				UpdateCoarseDepth(blockX, blockY);
 			}
 		}
 	}
 }
 
-void Renderer::ProcessRenderedTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float w0, float w1, float w2, int px, int py)
+void Renderer::UpdateCoarseDepth(int blockX, int blockY)
 {
-	//variables
-	const int bufferIdx{ px + (py * m_Width) };
-	ColorRGB finalColour{ 0.f, 0.f, 0.f };
+	const int endX{ std::min(blockX + RASTER_BLOCK_SIZE, m_Width) };
+	const int endY{ std::min(blockY + RASTER_BLOCK_SIZE, m_Height) };
+
+	//column wise first, a single reduction at the end
+	float columnMaxs[RASTER_BLOCK_SIZE]{};
+	for (int py{ blockY }; py < endY; ++py)
+	{
+		const float* pRow{ m_pDepthBufferPixels + (py * m_Width) };
+		for (int px{ blockX }; px < endX; ++px)
+		{
+			columnMaxs[px - blockX] = std::max(columnMaxs[px - blockX], pRow[px]);
+		}
+	}
+
+	m_pCoarseDepthBuffer[(blockX / RASTER_BLOCK_SIZE) + ((blockY / RASTER_BLOCK_SIZE) * m_CoarseDepthWidth)] = *std::max_element(columnMaxs, columnMaxs + (endX - blockX));
+}
+
+Renderer::TriangleSetup Renderer::SetupTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, uint32_t visibilityId) const
+{
+	TriangleSetup triangle{};
+	triangle.pVertices[0] = &v0;
+	triangle.pVertices[1] = &v1;
+	triangle.pVertices[2] = &v2;
+	triangle.visibilityId = visibilityId;
+
+	//the weights of a pixel always add up to twice the area of the triangle
+	triangle.invTriangleArea = 1.f / Vector2::Cross(v1.position.GetXY() - v0.position.GetXY(), v2.position.GetXY() - v0.position.GetXY());
+
+	for (int vertexIdx{}; vertexIdx < 3; ++vertexIdx)
+	{
+		triangle.depths[vertexIdx] = triangle.pVertices[vertexIdx]->position.z;
+	}
+
+	return triangle;
+}
+
+template<typename Pipeline>
+void Renderer::SetupAttributePlanes(TriangleSetup& triangle) const
+{
+	const Vertex_Out& v0{ *triangle.pVertices[0] };
+	const Vertex_Out& v1{ *triangle.pVertices[1] };
+	const Vertex_Out& v2{ *triangle.pVertices[2] };
+
+	//screen space gradients of the normalized weights, the edge steps of TriangleHandeling
+	const float weightStepX[3]{ (v1.position.y - v2.position.y) * triangle.invTriangleArea, (v2.position.y - v0.position.y) * triangle.invTriangleArea, (v0.position.y - v1.position.y) * triangle.invTriangleArea };
+	const float weightStepY[3]{ (v2.position.x - v1.position.x) * triangle.invTriangleArea, (v0.position.x - v2.position.x) * triangle.invTriangleArea, (v1.position.x - v0.position.x) * triangle.invTriangleArea };
+
+	//the weights are (1, 0, 0) at the first vertex => it's the origin of every plane
+	const auto setupPlane{ [&](float attribute0, float attribute1, float attribute2)
+		{
+			const float values[3]{ attribute0 * v0.position.w, attribute1 * v1.position.w, attribute2 * v2.position.w };
+			return AttributePlane
+			{
+				values[0],
+				weightStepX[0] * values[0] + weightStepX[1] * values[1] + weightStepX[2] * values[2],
+				weightStepY[0] * values[0] + weightStepY[1] * values[1] + weightStepY[2] * values[2]
+			};
+		} };
+	const auto setupPlanes{ [&setupPlane](const Vector3& attribute0, const Vector3& attribute1, const Vector3& attribute2, AttributePlane planes[3])
+		{
+			planes[0] = setupPlane(attribute0.x, attribute1.x, attribute2.x);
+			planes[1] = setupPlane(attribute0.y, attribute1.y, attribute2.y);
+			planes[2] = setupPlane(attribute0.z, attribute1.z, attribute2.z);
+		} };
 
-	//using right formula, see slides, has performance gain too
-	const float triangleArea{ w0 + w1 + w2 };
-	const float invTriangleArea{ 1.f / triangleArea };
+	//the depth buffer render mode only needs the depth
+	if constexpr (Pipeline::RENDER_MODE != Renderer::depthBuffer)
+	{
+		triangle.invW = setupPlane(1.f, 1.f, 1.f);
+		setupPlanes(DecodeUnitVector(v0.normal), DecodeUnitVector(v1.normal), DecodeUnitVector(v2.normal), triangle.normal);
+	}
+	if constexpr (Pipeline::IS_USING_TEXTURES)
+	{
+		triangle.uv[0] = setupPlane(v0.uv.x, v1.uv.x, v2.uv.x);
+		triangle.uv[1] = setupPlane(v0.uv.y, v1.uv.y, v2.uv.y);
+	}
+	if constexpr (Pipeline::IS_USING_NORMAL_MAP)
+	{
+		setupPlanes(DecodeUnitVector(v0.tangent), DecodeUnitVector(v1.tangent), DecodeUnitVector(v2.tangent), triangle.tangent);
+	}
+	if constexpr (Pipeline::IS_USING_SPECULAR)
+	{
+		setupPlanes(v0.viewDirection, v1.viewDirection, v2.viewDirection, triangle.viewDirection);
+	}
+}
 
+template<typename Float, typename Pipeline>
+bool Renderer::ProcessRenderedTriangle(const TriangleSetup& triangle, Float w0, Float w1, Float w2, Float mask, int px, int py)
+{
 	//normalize weights
-	w0 *= invTriangleArea;
-	w1 *= invTriangleArea;
-	w2 *= invTriangleArea;
+	w0 *= triangle.invTriangleArea;
+	w1 *= triangle.invTriangleArea;
+	w2 *= triangle.invTriangleArea;
 
 	//depth buffer -> only for comparing depth values; are not linear
-	const float invVerticeZ0{ (1.f / v0.position.z) * w0 }; 
-	const float invVerticeZ1{ (1.f / v1.position.z) * w1 }; 
-	const float invVerticeZ2{ (1.f / v2.position.z) * w2 }; 
 	//used for comparison in depth test and value we store in depth buffer
-	float zBufferValue{ 1.f / (invVerticeZ0 + invVerticeZ1 + invVerticeZ2) };
+	//NDC depth is linear in screen space, clipped vertices on the near plane have a depth of 0
+	Float zBufferValue{ w0 * triangle.depths[0] + w1 * triangle.depths[1] + w2 * triangle.depths[2] };
 
-	//check if value is in range of [0,1]
-	if (0.f > zBufferValue || zBufferValue > 1.f)
+	const Float depthBufferValue{ LoadBlock<Float>(m_pDepthBufferPixels, px, py) };
+	if constexpr (Pipeline::IS_TESTING_EQUAL_DEPTH)
 	{
-		return;
+		//the pre-pass computed the exact same depth for the triangle that won, nothing left to store
+		mask = mask & (zBufferValue == depthBufferValue);
+	}
+	else
+	{
+		//check if value is in range of [0,1] & passes the depth test
+		mask = mask & (zBufferValue >= 0.f) & (zBufferValue <= 1.f) & (zBufferValue <= depthBufferValue);
+	}
+
+	const int laneMask{ mask.MoveMask() };
+	if (laneMask == 0)
+	{
+		return false;
+	}
+
+	if constexpr (!Pipeline::IS_TESTING_EQUAL_DEPTH)
+	{
+		StoreBlock(Select(mask, zBufferValue, depthBufferValue), m_pDepthBufferPixels, px, py);
+	}
+
+	if constexpr (Pipeline::IS_WRITING_VISIBILITY)
+	{
+		//shading waits for the second pass, only the closest triangle of a pixel gets there
+		constexpr int blockWidth{ Float::BlockWidth };
+		for (int lane{}; lane < Float::Width; ++lane)
+		{
+			if (laneMask & (1 << lane))
+			{
+				m_pVisibilityBufferPixels[px + (lane % blockWidth) + ((py + lane / blockWidth) * m_Width)] = triangle.visibilityId;
+			}
+		}
+	}
+	else if constexpr (Pipeline::IS_SHADING)
+	{
+		ShadePixels<Float, Pipeline>(triangle, zBufferValue, laneMask, px, py);
+	}
+
+	return !Pipeline::IS_TESTING_EQUAL_DEPTH;
+}
+
+template<typename Float, typename Pipeline>
+void Renderer::ShadePixels(const TriangleSetup& triangle, Float zBufferValue, int laneMask, int px, int py)
+{
+	//variables
+	constexpr int blockWidth{ Float::BlockWidth };
+	Simd::ColorRGB<Float> finalColour{};
+
+	if constexpr (Pipeline::RENDER_MODE == Renderer::depthBuffer)
+	{
+		zBufferValue = Remap(zBufferValue, 0.9975f, 1.f);
+		finalColour = Simd::ColorRGB<Float>{ zBufferValue, zBufferValue, zBufferValue };
+	}
+	else
+	{
+		//pixel centers relative to the origin of the planes
+		const Vector2 origin{ triangle.pVertices[0]->position.GetXY() };
+		const Float x{ Float::LaneX() + (px + 0.5f - origin.x) };
+		const Float y{ Float::LaneY() + (py + 0.5f - origin.y) };
+		const auto evaluate{ [&x, &y](const AttributePlane& plane)
+			{
+				return x * plane.stepX + y * plane.stepY + plane.origin;
+			} };
+
+		//intepolate vertex attributes with correct depth, the only division of the pixel
+		const Float wInterpolated{ Float{ 1.f } / evaluate(triangle.invW) };
+		const auto interpolate{ [&evaluate, &wInterpolated](const AttributePlane& plane)
+			{
+				return evaluate(plane) * wInterpolated;
+			} };
+		const auto interpolateVector{ [&interpolate](const AttributePlane planes[3])
+			{
+				return Simd::Vector3<Float>{ interpolate(planes[0]), interpolate(planes[1]), interpolate(planes[2]) }.Normalized();
+			} };
+
+		//only the attributes the pipeline reads
+		Simd::Vertex_Out<Float> vertexOut{};
+
+		if constexpr (Pipeline::IS_USING_TEXTURES)
+		{
+			//uv isn't clamped here, the masked out lanes of a quad are needed for the uv derivatives
+			//the sampler clamps to [0, 1]
+			vertexOut.uv.x = interpolate(triangle.uv[0]);
+			vertexOut.uv.y = interpolate(triangle.uv[1]);
+		}
+
+		vertexOut.normal = interpolateVector(triangle.normal);
+		if constexpr (Pipeline::IS_USING_NORMAL_MAP)
+		{
+			vertexOut.tangent = interpolateVector(triangle.tangent);
+		}
+		if constexpr (Pipeline::IS_USING_SPECULAR)
+		{
+			vertexOut.viewDirection = interpolateVector(triangle.viewDirection);
+		}
+
+		finalColour = PixelShading<Float, Pipeline>(vertexOut, laneMask);
 	}
 
-	if (zBufferValue <= m_pDepthBufferPixels[bufferIdx])
-	{
-		m_pDepthBufferPixels[bufferIdx] = zBufferValue;
-
-		//intepolate vertex attributes with correct depth
-		const float invVerticeW0{ (1.f / v0.position.w) * w0 };
-		const float invVerticeW1{ (1.f / v1.position.w) * w1 };
-		const float invVerticeW2{ (1.f / v2.position.w) * w2 };
-		float wInterpolated{ 1.f / (invVerticeW0 + invVerticeW1 + invVerticeW2) };
-
-		//calculate interpolated uv coordinates
-		const Vector2 invUV0{ (v0.uv / v0.position.w) * w0 };
-		const Vector2 invUV1{ (v1.uv / v1.position.w) * w1 };
-		const Vector2 invUV2{ (v2.uv / v2.position.w) * w2 };
-		Vector2 interpolatedUV{ (invUV0 + invUV1 + invUV2) * wInterpolated };
-
-		//clamp interpolated uv value between [0, 1]
-		interpolatedUV.x = Clamp(interpolatedUV.x, 0.f, 1.f);
-		interpolatedUV.y = Clamp(interpolatedUV.y, 0.f, 1.f);
-
-		//calculate interpolated colour coordinates
-		const ColorRGB invColour0{ (v0.color / v0.position.w) * w0 };  
-		const ColorRGB invColour1{ (v1.color / v1.position.w) * w1 }; 
-		const ColorRGB invColour2{ (v2.color / v2.position.w) * w2 }; 
-		ColorRGB interpolatedColour{ (invColour0 + invColour1 + invColour2) * wInterpolated }; 
-
-		//calculate interpolated normal coordinates
-		const Vector3 invNormal0{ (v0.normal / v0.position.w) * w0 }; 
-		const Vector3 invNormal1{ (v1.normal / v1.position.w) * w1 }; 
-		const Vector3 invNormal2{ (v2.normal / v2.position.w) * w2 }; 
-		Vector3 interpolatedNormal{ (invNormal0 + invNormal1 + invNormal2) * wInterpolated }; 
-
-		//calculate interpolated tangent coordinates
-		const Vector3 invTangent0{ (v0.tangent / v0.position.w) * w0 }; 
-		const Vector3 invTangent1{ (v1.tangent / v1.position.w) * w1 }; 
-		const Vector3 invTangent2{ (v2.tangent / v2.position.w) * w2 }; 
-		Vector3 interpolatedTangent{ (invTangent0 + invTangent1 + invTangent2) * wInterpolated }; 
-
-		//calculate interpolated viewDirection coordinates
-		const Vector3 invViewDirection0{ (v0.viewDirection / v0.position.w) * w0 };
-		const Vector3 invViewDirection1{ (v1.viewDirection / v1.position.w) * w1 };
-		const Vector3 invViewDirection2{ (v2.viewDirection / v2.position.w) * w2 };
-		Vector3 interpolatedViewDirection{ (invViewDirection0 + invViewDirection1 + invViewDirection2) * wInterpolated };
-
-		Vertex_Out vertexOut{};
-		vertexOut.uv            = interpolatedUV;
-		vertexOut.color         = interpolatedColour; 
-		vertexOut.normal        = interpolatedNormal.Normalized(); 
-		vertexOut.tangent       = interpolatedTangent.Normalized(); 
-		vertexOut.viewDirection = interpolatedViewDirection.Normalized();
-
-		switch (m_RenderMode)
+	finalColour.MaxToOne();
+
+	uint32_t pixels[Float::Width]{};
+	StorePixels(finalColour.r, finalColour.g, finalColour.b, m_PixelFormat, pixels);
+
+	//write the pixels of the block that passed, a full row at once
+	constexpr int rowMask{ (1 << blockWidth) - 1 };
+	for (int row{}; row < 2; ++row)
+	{
+		uint32_t* pRow{ m_pBackBufferPixels + px + ((py + row) * m_Width) };
+		const uint32_t* pRowPixels{ pixels + (row * blockWidth) };
+		const int rowLaneMask{ (laneMask >> (row * blockWidth)) & rowMask };
+
+		if (rowLaneMask == rowMask)
 		{
-		case Renderer::finalColour:
-			finalColour = PixelShading(vertexOut);
-			break;
-		case Renderer::depthBuffer:
-			zBufferValue = Remap(zBufferValue, 0.9975f, 1.f);
-			finalColour = ColorRGB{ zBufferValue, zBufferValue, zBufferValue };
-			break;
+			std::copy_n(pRowPixels, blockWidth, pRow);
+			continue;
 		}
 
-		finalColour.MaxToOne();
+		for (int lane{}; lane < blockWidth; ++lane)
+		{
+			if (rowLaneMask & (1 << lane))
+			{
+				pRow[lane] = pRowPixels[lane];
+			}
+		}
+	}
+}
 
-		m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-			static_cast<uint8_t>(finalColour.r * 255),
-			static_cast<uint8_t>(finalColour.g * 255),
-			static_cast<uint8_t>(finalColour.b * 255));
+template<typename Float>
+Float Renderer::LoadBlock(const float* pBuffer, int px, int py) const
+{
+	constexpr int blockWidth{ Float::BlockWidth };
+
+	if (px + blockWidth <= m_Width && py + 2 <= m_Height)
+	{
+		return Float::LoadRows(pBuffer + px + (py * m_Width), pBuffer + px + ((py + 1) * m_Width));
+	}
+
+	//block sticks out of the screen, only read the pixels on it
+	float values[Float::Width]{};
+	for (int lane{}; lane < Float::Width; ++lane)
+	{
+		const int x{ px + (lane % blockWidth) };
+		const int y{ py + (lane / blockWidth) };
+
+		if (x < m_Width && y < m_Height)
+		{
+			values[lane] = pBuffer[x + (y * m_Width)];
+		}
 	}
+	return Float::Load(values);
 }
 
-float Renderer::Remap(float value, float inputMin, float inputMax)
+template<typename Float>
+void Renderer::StoreBlock(const Float& value, float* pBuffer, int px, int py) const
 {
-	const float temp{ (value - inputMin) / (inputMax - inputMin) };
+	//blocks are aligned to their size and tiles to TILE_SIZE => a block on screen never crosses into another tile
+	constexpr int blockWidth{ Float::BlockWidth };
+
+	if (px + blockWidth <= m_Width && py + 2 <= m_Height)
+	{
+		value.StoreRows(pBuffer + px + (py * m_Width), pBuffer + px + ((py + 1) * m_Width));
+		return;
+	}
+
+	//block sticks out of the screen, only write the pixels on it
+	float values[Float::Width]{};
+	value.Store(values);
+	for (int lane{}; lane < Float::Width; ++lane)
+	{
+		const int x{ px + (lane % blockWidth) };
+		const int y{ py + (lane / blockWidth) };
+
+		if (x < m_Width && y < m_Height)
+		{
+			pBuffer[x + (y * m_Width)] = values[lane];
+		}
+	}
+}
+
+template<typename Float>
+Float Renderer::Remap(const Float& value, float inputMin, float inputMax) const
+{
+	const Float temp{ (value - inputMin) / (inputMax - inputMin) };
 	return temp;
 }
 
-ColorRGB Renderer::PixelShading(const Vertex_Out& v)
+template<typename Float, typename Pipeline>
+Simd::ColorRGB<Float> Renderer::PixelShading(const Simd::Vertex_Out<Float>& v, int laneMask) const
 {
 	//const variables
-	const ColorRGB ambient{ 0.03f, 0.03f , 0.03f }; 
-	const Vector3 lightDirection{ 0.577f, -0.577f, 0.577f }; 
+	const Simd::ColorRGB<Float> ambient{ 0.03f, 0.03f , 0.03f }; 
+	const Simd::Vector3<Float> lightDirection{ 0.577f, -0.577f, 0.577f }; 
 	const float lightIntensity{ 7.f };
 	const float diffuseCoeffient{ 1.f }; 
 	const float shininess{ 25.f };
 
 	//variables
-	float observedArea{};
-	ColorRGB finalColour{};
+	Float observedArea{};
+	Simd::ColorRGB<Float> finalColour{};
 
-	//sample texture maps
-	const ColorRGB diffuseColour{ m_pDiffuseTexture->Sample(v.uv) }; 
-	const ColorRGB glossColour{ m_pGlossTexture->Sample(v.uv) };
-	const ColorRGB normalTextureSample{ m_pNormalTexture->Sample(v.uv) }; 
-	const ColorRGB specularColour{ m_pSpecularTexture->Sample(v.uv) };
+	//sample texture maps, the lanes that got masked out stay black
+	float diffuseSamples[3][Float::Width]{};
+	float glossSamples[Float::Width]{};
+	float normalSamples[3][Float::Width]{};
+	float specularSamples[3][Float::Width]{};
 
-	//create tangent space transformation matrix
-	const Vector3 binormal{ Vector3::Cross(v.normal, v.tangent) };
-	const Matrix tangentSpaceAxis{ v.tangent, binormal, v.normal, {0.f, 0.f, 0.f} };
+	if constexpr (Pipeline::IS_USING_TEXTURES)
+	{
+		//maps this pipeline reads, the others aren't fetched
+		constexpr uint8_t maps{ static_cast<uint8_t>((Pipeline::IS_USING_DIFFUSE ? diffuseMap : 0) | (Pipeline::IS_USING_SPECULAR ? (glossMap | specularMap) : 0) | (Pipeline::IS_USING_NORMAL_MAP ? normalMap : 0)) };
+
+		float u[Float::Width]{};
+		float uv_v[Float::Width]{};
+		v.uv.x.Store(u);
+		v.uv.y.Store(uv_v);
+
+		//a block is made of 2x2 quads, the pixels of a quad share the mip level of their uv derivatives
+		constexpr int blockWidth{ Float::BlockWidth };
+		float mipLevels[Float::Width]{};
+		for (int quadX{}; quadX < blockWidth; quadX += 2)
+		{
+			const Vector2 uvDerivativeX{ u[quadX + 1] - u[quadX], uv_v[quadX + 1] - uv_v[quadX] };
+			const Vector2 uvDerivativeY{ u[quadX + blockWidth] - u[quadX], uv_v[quadX + blockWidth] - uv_v[quadX] };
+			const float mipLevel{ m_pMaterialTexture->GetMipLevel(uvDerivativeX, uvDerivativeY) };
+
+			mipLevels[quadX] = mipLevel;
+			mipLevels[quadX + 1] = mipLevel;
+			mipLevels[quadX + blockWidth] = mipLevel;
+			mipLevels[quadX + blockWidth + 1] = mipLevel;
+		}
 
-	//sample from normal map and multiply it with matrix
-	Vector3 sampledNormal{ normalTextureSample.r, normalTextureSample.g, normalTextureSample.b }; 
+		for (int lane{}; lane < Float::Width; ++lane)
+		{
+			if (laneMask & (1 << lane))
+			{
+				//one fetch for all four maps
+				const MaterialSample sample{ m_pMaterialTexture->Sample(Vector2{ u[lane], uv_v[lane] }, mipLevels[lane], maps) };
+
+				diffuseSamples[0][lane] = sample.diffuse.r;
+				diffuseSamples[1][lane] = sample.diffuse.g;
+				diffuseSamples[2][lane] = sample.diffuse.b;
+				glossSamples[lane] = sample.gloss;
+				normalSamples[0][lane] = sample.normal.r;
+				normalSamples[1][lane] = sample.normal.g;
+				normalSamples[2][lane] = sample.normal.b;
+				specularSamples[0][lane] = sample.specular.r;
+				specularSamples[1][lane] = sample.specular.g;
+				specularSamples[2][lane] = sample.specular.b;
+			}
+		}
+	}
 
-	//change range [0, 1] to [-1, 1]
-	sampledNormal = 2.f * sampledNormal - Vector3{ 1.f, 1.f, 1.f }; 
-	sampledNormal = tangentSpaceAxis.TransformVector(sampledNormal).Normalized();
+	Simd::Vector3<Float> sampledNormal{};
+	if constexpr (Pipeline::IS_USING_NORMAL_MAP)
+	{
+		//create tangent space transformation, tangent/binormal/normal are the axes
+		const Simd::Vector3<Float> binormal{ Simd::Vector3<Float>::Cross(v.normal, v.tangent) };
+
+		//sample from normal map, change range [0, 1] to [-1, 1] and transform it
+		const Float sampledX{ Float::Load(normalSamples[0]) * 2.f - 1.f };
+		const Float sampledY{ Float::Load(normalSamples[1]) * 2.f - 1.f };
+		const Float sampledZ{ Float::Load(normalSamples[2]) * 2.f - 1.f };
+		sampledNormal = (v.tangent * sampledX + binormal * sampledY + v.normal * sampledZ).Normalized();
+	}
 
-	if (m_IsShowingNormalMap)
+	if constexpr (Pipeline::IS_SHOWING_NORMAL_MAP)
 	{
 		//observed area
-		observedArea = Vector3::Dot(sampledNormal, -lightDirection);
+		observedArea = Simd::Vector3<Float>::Dot(sampledNormal, -lightDirection);
 	}
 	else
 	{
 		//observed area
-		observedArea = Vector3::Dot(v.normal, -lightDirection);
+		observedArea = Simd::Vector3<Float>::Dot(v.normal, -lightDirection);
 	}
 
-	if (observedArea <= 0) 
+	//calculate lambert diffuse
+	Simd::ColorRGB<Float> lambertDiffuse{};
+	if constexpr (Pipeline::IS_USING_DIFFUSE)
 	{
-		return ColorRGB{ 0.f, 0.f, 0.f }; 
+		const Simd::ColorRGB<Float> diffuseColour{ Float::Load(diffuseSamples[0]), Float::Load(diffuseSamples[1]), Float::Load(diffuseSamples[2]) };
+		lambertDiffuse = diffuseColour * (diffuseCoeffient / PI);
 	}
-	
-	//shading mode calculations
-	const ColorRGB exponent{ glossColour * shininess }; 
-
-	//calculate lambert diffuse
-	const ColorRGB lambertDiffuse{ (diffuseCoeffient * diffuseColour) / float(M_PI) }; 
 
 	//calculate phong reflection
-	const Vector3 reflect{ lightDirection - (2.f * Vector3::Dot(sampledNormal, lightDirection) * sampledNormal) };
-	const float angle{ std::max(0.f, Vector3::Dot(reflect, -v.viewDirection)) };
-	const ColorRGB specular{ specularColour * std::powf(angle, exponent.r) };
+	Simd::ColorRGB<Float> specular{};
+	if constexpr (Pipeline::IS_USING_SPECULAR)
+	{
+		const Float glossColour{ Float::Load(glossSamples) };
+		const Simd::ColorRGB<Float> specularColour{ Float::Load(specularSamples[0]), Float::Load(specularSamples[1]), Float::Load(specularSamples[2]) };
+		const Float exponent{ glossColour * shininess };
 
-	switch (m_ShadingMode)
+		const Simd::Vector3<Float> reflect{ lightDirection - sampledNormal * (Simd::Vector3<Float>::Dot(sampledNormal, lightDirection) * 2.f) };
+		const Float angle{ Max(Float{ 0.f }, Simd::Vector3<Float>::Dot(reflect, -v.viewDirection)) };
+		specular = specularColour * Pow(angle, exponent);
+	}
+
+	//shading mode calculations
+	if constexpr (Pipeline::SHADING_MODE == Renderer::observedArea)
 	{
-	case Renderer::observedArea:
-		finalColour = ColorRGB{ observedArea, observedArea, observedArea };
-		break;
-	case Renderer::diffuseMode:
-		finalColour = lightIntensity * lambertDiffuse * observedArea;
-		break;
-	case Renderer::specularMode:
-		finalColour = specular * observedArea; 
-		break;
-	case Renderer::combinedMode:
-		finalColour = ((lambertDiffuse * lightIntensity) + specular + ambient) * observedArea;
-		break;
+		finalColour = Simd::ColorRGB<Float>{ observedArea, observedArea, observedArea };
+	}
+	else if constexpr (Pipeline::SHADING_MODE == Renderer::diffuseMode)
+	{
+		finalColour = lambertDiffuse * (observedArea * lightIntensity);
 	}
+	else if constexpr (Pipeline::SHADING_MODE == Renderer::specularMode)
+	{
+		finalColour = specular * observedArea;
+	}
+	else
+	{
+		finalColour = ((lambertDiffuse * Float{ lightIntensity }) + specular + ambient) * observedArea;
+	}
+
+	//pixels facing away from the light are black
+	const Float isLit{ observedArea > 0.f };
+	finalColour.r = Select(isLit, finalColour.r, Float{ 0.f });
+	finalColour.g = Select(isLit, finalColour.g, Float{ 0.f });
+	finalColour.b = Select(isLit, finalColour.b, Float{ 0.f });
 
 	return finalColour;
 }
 
-void Renderer::VertexTransformationFunction(std::vector<Mesh>& meshes_in) const
+void Renderer::VertexTransformationFunction(const std::vector<Mesh>& meshes_in)
 {
-	for (Mesh& mesh : meshes_in)
+	//every mesh owns a fixed range of the transformed vertices, the buffer only grows when the meshes do
+	m_FirstTransformedVertexIndices.resize(meshes_in.size());
+	uint32_t transformedVertexCount{};
+	for (uint32_t meshIdx{}; meshIdx < meshes_in.size(); ++meshIdx)
 	{
-		const Matrix worldViewProjectionMatrix{ mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
-		mesh.vertices_out.clear();
-		mesh.vertices_out.reserve(mesh.vertices.size());
+		m_FirstTransformedVertexIndices[meshIdx] = transformedVertexCount;
+		transformedVertexCount += static_cast<uint32_t>(meshes_in[meshIdx].vertexStreams.vertexCount);
+	}
+	if (m_TransformedVertices.size() < transformedVertexCount)
+	{
+		m_TransformedVertices.resize(transformedVertexCount);
+	}
 
-		for (Vertex& vertice : mesh.vertices)
+	//split every mesh in chunks of vertices, small meshes are one job & huge ones get spread over every thread
+	m_VertexJobs.clear();
+	for (uint32_t meshIdx{}; meshIdx < meshes_in.size(); ++meshIdx)
+	{
+		const Mesh& mesh{ meshes_in[meshIdx] };
+		if (!mesh.isVisible)
 		{
-			Vector4 transformedPosition{ worldViewProjectionMatrix.TransformPoint(Vector4{vertice.position, 1.f}) };
-
-			//first was overriding vertices normal & tangent
-			//making temp variable instead
-			const Vector3 newNormal{ mesh.worldMatrix.TransformVector(vertice.normal).Normalized() };
-			const Vector3 newTangent{ mesh.worldMatrix.TransformVector(vertice.tangent).Normalized() };
-			const Vector3 newViewDirection{ mesh.worldMatrix.TransformVector(vertice.position) - m_Camera.origin };
-
-			//model to NDC space
-			transformedPosition.x /= transformedPosition.w;
-			transformedPosition.y /= transformedPosition.w;
-			transformedPosition.z /= transformedPosition.w;
-
-			//projection to screen space
-			transformedPosition.x = ((transformedPosition.x + 1.f) / 2.f) * m_Width;
-			transformedPosition.y = ((1.f - transformedPosition.y) / 2.f) * m_Height;
-
-			Vertex_Out& vertex_out{ mesh.vertices_out.emplace_back(Vertex_Out{}) };
-			vertex_out.position = transformedPosition;
-			vertex_out.color = vertice.color;
-			vertex_out.uv = vertice.uv;
-			vertex_out.normal = newNormal; 
-			vertex_out.tangent = newTangent; 
-			vertex_out.viewDirection = newViewDirection; 
+			continue;
+		}
+
+		const uint32_t vertexCount{ static_cast<uint32_t>(mesh.vertexStreams.vertexCount) };
+		for (uint32_t firstIdx{}; firstIdx < vertexCount; firstIdx += VERTEX_JOB_VERTICES)
+		{
+			m_VertexJobs.push_back({ meshIdx, firstIdx, std::min(firstIdx + VERTEX_JOB_VERTICES, vertexCount) });
 		}
 	}
+
+	//every vertex gets written by exactly one job => no locking needed
+	m_pThreadPool->ParallelFor(static_cast<uint32_t>(m_VertexJobs.size()), [this, &meshes_in](uint32_t vertexJobIdx)
+		{
+			const VertexJob& job{ m_VertexJobs[vertexJobIdx] };
+			Vertex_Out* pVerticesOut{ m_TransformedVertices.data() + m_FirstTransformedVertexIndices[job.meshIdx] };
+			TransformVertices(meshes_in[job.meshIdx], pVerticesOut, job.firstVertexIdx, job.lastVertexIdx);
+		});
 }
 
-bool Renderer::ClipAgainstNearFarPlane(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const float nearPlane, const float farPlane, std::vector<Vertex_Out>& clippedVertices)
+void Renderer::TransformVertices(const Mesh& mesh, Vertex_Out* pVerticesOut, uint32_t firstVertexIdx, uint32_t lastVertexIdx) const
 {
-	//check if all vertices are behind the near plane or in front of the far plane
-	if ((v0.position.z < nearPlane && v1.position.z < nearPlane && v2.position.z < nearPlane) || 
-		(v0.position.z > farPlane && v1.position.z > farPlane && v2.position.z > farPlane)) 
+	switch (m_SimdMode)
 	{
-		//no clipping needed
-		return false;
+	case Renderer::sseMode:
+		TransformVertices<Simd::SseFloat4>(mesh, pVerticesOut, firstVertexIdx, lastVertexIdx);
+		break;
+	case Renderer::avx2Mode:
+		TransformVertices<Simd::AvxFloat8>(mesh, pVerticesOut, firstVertexIdx, lastVertexIdx);
+		break;
+	default:
+		TransformVertices<Simd::ScalarFloat4>(mesh, pVerticesOut, firstVertexIdx, lastVertexIdx);
+		break;
 	}
+}
 
-	//clip against the near plane 
-	if (v0.position.z < nearPlane || v1.position.z < nearPlane || v2.position.z < nearPlane)  
-	{
-		float temp0{ nearPlane / v0.position.z }; 
-		float temp1{ nearPlane / v1.position.z }; 
-		float temp2{ nearPlane / v2.position.z }; 
+const Vertex_Out* Renderer::GetTransformedVertices(uint32_t meshIdx) const
+{
+	return m_TransformedVertices.data() + m_FirstTransformedVertexIndices[meshIdx];
+}
+
+template<typename Float>
+void Renderer::TransformVertices(const Mesh& mesh, Vertex_Out* pVerticesOut, uint32_t firstVertexIdx, uint32_t lastVertexIdx) const
+{
+	const Matrix worldViewProjectionMatrix{ mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix };
+	const VertexStreams& streams{ mesh.vertexStreams };
 
-		//calculate new clipped vertices and append them to the vector
-		clippedVertices.emplace_back(Vector4{ v0.position.x * temp0, v0.position.y * temp0, nearPlane, 1.f });
-		clippedVertices.emplace_back(Vector4{ v1.position.x * temp1, v1.position.y * temp1, nearPlane, 1.f });
-		clippedVertices.emplace_back(Vector4{ v2.position.x * temp2, v2.position.y * temp2, nearPlane, 1.f });
+	//every lane uses the same matrices => broadcast their elements once
+	Float worldViewProjection[4][4]{};
+	Float world[4][3]{};
+	for (int rowIdx{}; rowIdx < 4; ++rowIdx)
+	{
+		for (int columnIdx{}; columnIdx < 4; ++columnIdx)
+		{
+			worldViewProjection[rowIdx][columnIdx] = worldViewProjectionMatrix[rowIdx][columnIdx];
+		}
+		for (int columnIdx{}; columnIdx < 3; ++columnIdx)
+		{
+			world[rowIdx][columnIdx] = mesh.worldMatrix[rowIdx][columnIdx];
+		}
 	}
 
-	//clip against the far plane
-	if (v0.position.z > farPlane || v1.position.z > farPlane || v2.position.z > farPlane) 
+	const auto transformVector{ [&world](const Simd::Vector3<Float>& v)
+		{
+			return Simd::Vector3<Float>{
+				world[0][0] * v.x + world[1][0] * v.y + world[2][0] * v.z,
+				world[0][1] * v.x + world[1][1] * v.y + world[2][1] * v.z,
+				world[0][2] * v.x + world[1][2] * v.y + world[2][2] * v.z
+			};
+		} };
+
+	const Float width{ static_cast<float>(m_Width) };
+	const Float height{ static_cast<float>(m_Height) };
+	const Simd::Vector3<Float> cameraOrigin{ m_Camera.origin.x, m_Camera.origin.y, m_Camera.origin.z };
+
+	for (uint32_t vertexIdx{ firstVertexIdx }; vertexIdx < lastVertexIdx; vertexIdx += Float::Width)
 	{
-		float temp0{ farPlane / v0.position.z }; 
-		float temp1{ farPlane / v1.position.z }; 
-		float temp2{ farPlane / v2.position.z };
+		const Simd::Vector3<Float> position{ Float::Load(&streams.positionX[vertexIdx]), Float::Load(&streams.positionY[vertexIdx]), Float::Load(&streams.positionZ[vertexIdx]) };
+		const Simd::Vector3<Float> normal{ Float::Load(&streams.normalX[vertexIdx]), Float::Load(&streams.normalY[vertexIdx]), Float::Load(&streams.normalZ[vertexIdx]) };
+		const Simd::Vector3<Float> tangent{ Float::Load(&streams.tangentX[vertexIdx]), Float::Load(&streams.tangentY[vertexIdx]), Float::Load(&streams.tangentZ[vertexIdx]) };
+		const Float uvX{ Float::Load(&streams.uvX[vertexIdx]) };
+		const Float uvY{ Float::Load(&streams.uvY[vertexIdx]) };
+
+		Float clipPosition[4]{};
+		for (int columnIdx{}; columnIdx < 4; ++columnIdx)
+		{
+			clipPosition[columnIdx] = worldViewProjection[0][columnIdx] * position.x + worldViewProjection[1][columnIdx] * position.y + worldViewProjection[2][columnIdx] * position.z + worldViewProjection[3][columnIdx];
+		}
 
-		//calculate new clipped vertices and append them to the vector
-		clippedVertices.emplace_back(Vector4{ v0.position.x * temp0, v0.position.y * temp0, farPlane, 1.f });
-		clippedVertices.emplace_back(Vector4{ v1.position.x * temp1, v1.position.y * temp1, farPlane, 1.f });
-		clippedVertices.emplace_back(Vector4{ v2.position.x * temp2, v2.position.y * temp2, farPlane, 1.f });
-	}
+		//model to NDC to screen space like ProjectToScreen, triangles crossing the near plane get clipped during binning
+		const Float invW{ Float{ 1.f } / clipPosition[3] };
+		const Float screenX{ ((clipPosition[0] * invW + 1.f) / 2.f) * width };
+		const Float screenY{ ((Float{ 1.f } - clipPosition[1] * invW) / 2.f) * height };
+		const Float screenZ{ clipPosition[2] * invW };
+
+		//encoding only keeps the direction => no need to normalize
+		const Float newNormal{ Simd::EncodeUnitVector(transformVector(normal)) };
+		const Float newTangent{ Simd::EncodeUnitVector(transformVector(tangent)) };
+		const Simd::Vector3<Float> newViewDirection{ transformVector(position) - cameraOrigin };
+
+		//back to one Vertex_Out per lane, every component is computed => a plain transpose, the rasterizer reads whole vertices
+		float lanes[11][Float::Width]{};
+		const Float* pComponents[11]{ &screenX, &screenY, &screenZ, &invW, &uvX, &uvY, &newNormal, &newTangent, &newViewDirection.x, &newViewDirection.y, &newViewDirection.z };
+		for (int componentIdx{}; componentIdx < 11; ++componentIdx)
+		{
+			pComponents[componentIdx]->Store(lanes[componentIdx]);
+		}
 
-	//clipping occurred
-	return true;
+		const uint32_t laneCount{ std::min(static_cast<uint32_t>(Float::Width), lastVertexIdx - vertexIdx) };
+		for (uint32_t laneIdx{}; laneIdx < laneCount; ++laneIdx)
+		{
+			Vertex_Out& vertex_out{ pVerticesOut[vertexIdx + laneIdx] };
+			vertex_out.position = { lanes[0][laneIdx], lanes[1][laneIdx], lanes[2][laneIdx], lanes[3][laneIdx] };
+			vertex_out.uv = { lanes[4][laneIdx], lanes[5][laneIdx] };
+			vertex_out.normal = std::bit_cast<uint32_t>(lanes[6][laneIdx]);
+			vertex_out.tangent = std::bit_cast<uint32_t>(lanes[7][laneIdx]);
+			vertex_out.viewDirection = { lanes[8][laneIdx], lanes[9][laneIdx], lanes[10][laneIdx] };
+		}
+	}
 }
 
 void Renderer::SetIsRotating()
@@ -464,6 +1469,21 @@ void Renderer::ShadingModeCycling()
 	m_ShadingMode = static_cast<ShadingMode>((++temp) % 4);
 }
 
+void Renderer::PassModeCycling()
+{
+	int temp{ static_cast<int>(m_PassMode) };
+	m_PassMode = static_cast<PassMode>((++temp) % 3);
+}
+
+void Renderer::CullModeCycling()
+{
+	for (Mesh& mesh : m_MeshesObject)
+	{
+		int temp{ static_cast<int>(mesh.cullMode) };
+		mesh.cullMode = static_cast<CullMode>((++temp) % 3);
+	}
+}
+
 void Renderer::MeshRotation(Timer* pTimer)
 {
 	//update rotation of object
@@ -4,6 +4,8 @@
 #include <vector>
 
 #include "Camera.h"
+#include "FrameArena.h"
+#include "SimdMath.h"
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -11,11 +13,19 @@ struct SDL_Surface;
 namespace dae
 {
 	class Texture;
+	class MaterialTexture;
 	struct Mesh;
 	struct Vertex;
 	struct Vertex_Out;
+	enum class CullMode;
 	class Timer;
 	class Scene;
+	class ThreadPool;
+
+	namespace Simd
+	{
+		template<typename Float> struct Vertex_Out;
+	}
 
 	class Renderer final
 	{
@@ -32,6 +42,8 @@ namespace dae
 		void Render();
 
 		bool SaveBufferToImage() const;
+		//heap allocations during the last Render(), 0 once every buffer has grown to the scene
+		uint64_t GetFrameAllocationCount() const { return m_FrameAllocationCount; }
 
 		//------ Render Functions ------
 		//void Render_W1_Part1();
@@ -62,36 +74,244 @@ namespace dae
 			combinedMode
 		};
 
+		//how the pixel pipeline keeps overdraw from being shaded
+		enum PassMode
+		{
+			//shade whatever passes the depth test
+			singlePass,
+			//depth only first, then shade what has the exact depth of the first pass
+			depthPrePass,
+			//depth & triangle ids first, then shade every pixel once
+			visibilityBuffer
+		};
+
+		//instruction set the pixel pipeline runs on, picked at startup
+		enum SimdMode
+		{
+			scalarMode,
+			sseMode,
+			avx2Mode
+		};
+
 		//------ Own Functions ------
 		float Calculate2DCrossProduct(const Vector3& a, const Vector3& b, const Vector2& c);
-		float Remap(float value, float inputMin, float inputMax);
-		ColorRGB PixelShading(const Vertex_Out& v);
+		template<typename Float>
+		Float Remap(const Float& value, float inputMin, float inputMax) const;
+		template<typename Float, typename Pipeline>
+		Simd::ColorRGB<Float> PixelShading(const Simd::Vertex_Out<Float>& v, int laneMask) const;
 
 		bool IsPixelInTriangle(const Vector2& p, const std::vector<Vertex>& vertex, const int index);
 
 		void MeshRotation(Timer* pTimer);
 
 		void PixelHandeling(int px, int py, int triangleIdx, const std::vector<Vertex>& vertex_transformed);
-		void TriangleHandeling(int triangleIdx, const Mesh& mesh_transformed);
-		void ProcessRenderedTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, float w0, float w1, float w2, int px, int py); 
+		void BinTriangles(uint32_t binningJobIdx);
+		void RenderTile(uint32_t tileIdx);
+		template<typename Float, typename Pipeline>
+		void RasterizeTile(uint32_t tileIdx, const Int2& tileMin, const Int2& tileMax);
+		template<typename Float, typename Pipeline>
+		void TriangleHandeling(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const Int2& tileMin, const Int2& tileMax, uint32_t visibilityId);
 
 		void VertexTransformationFunction(const std::vector<Vertex>& vertices_in, std::vector<Vertex>& vertices_out) const;
-		void VertexTransformationFunction(std::vector<Mesh>& meshes_in) const;
+		void VertexTransformationFunction(const std::vector<Mesh>& meshes_in);
+		void TransformVertices(const Mesh& mesh, Vertex_Out* pVerticesOut, uint32_t firstVertexIdx, uint32_t lastVertexIdx) const;
+		//Float::Width vertices per iteration, read from the vertex streams of the mesh
+		template<typename Float>
+		void TransformVertices(const Mesh& mesh, Vertex_Out* pVerticesOut, uint32_t firstVertexIdx, uint32_t lastVertexIdx) const;
+		//vertex stage output of a mesh, indexed like its vertices
+		const Vertex_Out* GetTransformedVertices(uint32_t meshIdx) const;
 
-		bool ClipAgainstNearFarPlane(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, const float nearPlane, const float farPlane, std::vector<Vertex_Out>& clippedVertices);
 		void SetIsRotating();
 		void SetIsShowingNormalMap();
 		void RenderModeCycling();
 		void ShadingModeCycling();
+		void CullModeCycling();
+		void PassModeCycling();
 
 	private:
+		//------ Tile Binning ------
+		//screen is split in square tiles, every tile is rasterized by a single thread
+		static constexpr int TILE_SIZE{ 64 };
+		//vertices are transformed in chunks of this many, a multiple of VertexStreams::PADDING => SIMD loads never straddle two jobs
+		static constexpr uint32_t VERTEX_JOB_VERTICES{ 4096 };
+		//triangles are binned in chunks of this many, one chunk per binning job
+		static constexpr uint32_t BINNING_JOB_TRIANGLES{ 4096 };
+		//triangles are rasterized in square blocks of pixels, empty blocks are skipped at once
+		static constexpr int RASTER_BLOCK_SIZE{ 8 };
+		//the coarse depth bounds of a triangle are a little off from its per pixel depths, don't reject on rounding
+		static constexpr float COARSE_DEPTH_EPSILON{ 1e-5f };
+
+		struct VertexJob
+		{
+			uint32_t meshIdx{};
+			uint32_t firstVertexIdx{};
+			uint32_t lastVertexIdx{};
+		};
+
+		struct BinningJob
+		{
+			uint32_t meshIdx{};
+			uint32_t firstTriangleIdx{};
+			uint32_t lastTriangleIdx{};
+		};
+
+		struct BinnedTriangle
+		{
+			uint32_t meshIdx{};
+			uint32_t triangleIdx{};
+		};
+
+		//per frame containers, their memory comes from the frame arena
+		using TileBin = std::vector<BinnedTriangle, FrameAllocator<BinnedTriangle>>;
+		using ClippedVertices = std::vector<Vertex_Out, FrameAllocator<Vertex_Out>>;
+
+		//------ Clipping ------
+		//x & y only get clipped outside this many times the viewport, the bounding box clamp handles the rest
+		static constexpr float GUARD_BAND_SCALE{ 8.f };
+		//the near plane & 4 guard band planes add at most one vertex each
+		static constexpr int MAX_CLIPPED_VERTICES{ 3 + 5 };
+		//bins of clipped triangles point in the clipped vertices of their binning job instead of a mesh
+		static constexpr uint32_t CLIPPED_MESH_IDX{ UINT32_MAX };
+
+		//planes a vertex is outside of, a triangle outside the same plane with all vertices is invisible
+		enum OutCode : uint8_t
+		{
+			insideCode = 0,
+			nearCode = 1 << 0,
+			farCode = 1 << 1,
+			leftCode = 1 << 2,
+			rightCode = 1 << 3,
+			topCode = 1 << 4,
+			bottomCode = 1 << 5,
+			guardBandCode = 1 << 6
+		};
+
+		uint8_t ComputeOutCode(const Vector4& position) const;
+		//bounding sphere first, the box only when the sphere crosses a plane
+		bool IsMeshInFrustum(const Mesh& mesh, const Matrix& worldViewProjectionMatrix) const;
+		Vector4 ProjectToScreen(const Vector4& clipPosition) const;
+		static Vertex_Out LerpVertex(const Vertex_Out& v0, const Vertex_Out& v1, float factor);
+		//odd triangles of a strip get flipped to keep the winding
+		void GetTriangleIndices(const Mesh& mesh, uint32_t triangleIdx, uint32_t indices[3]) const;
+		//appends the clipped triangle as a fan of screen space triangles
+		void ClipTriangle(const Matrix& worldViewProjectionMatrix, const Mesh& mesh, const Vertex_Out* pTransformedVertices, const uint32_t indices[3], ClippedVertices& clippedVertices) const;
+		void BinTriangle(TileBin* pBins, const Vector4& p0, const Vector4& p1, const Vector4& p2, const BinnedTriangle& triangle, CullMode cullMode) const;
+
+		//------ Pixel Pipeline ------
+		//the modes a pixel pipeline is compiled for => no mode switches per pixel
+		template<RenderMode renderMode, ShadingMode shadingMode, bool isShowingNormalMap>
+		struct PixelPipeline
+		{
+			static constexpr RenderMode RENDER_MODE{ renderMode };
+			static constexpr ShadingMode SHADING_MODE{ shadingMode };
+			static constexpr bool IS_SHOWING_NORMAL_MAP{ isShowingNormalMap };
+			static constexpr bool IS_SHADING{ true };
+			static constexpr bool IS_WRITING_VISIBILITY{ false };
+			static constexpr bool IS_TESTING_EQUAL_DEPTH{ false };
+
+			//what the pipeline reads, the rest is never interpolated or sampled
+			static constexpr bool IS_USING_DIFFUSE{ renderMode == finalColour && (shadingMode == diffuseMode || shadingMode == combinedMode) };
+			static constexpr bool IS_USING_SPECULAR{ renderMode == finalColour && (shadingMode == specularMode || shadingMode == combinedMode) };
+			//the specular reflection always uses the sampled normal
+			static constexpr bool IS_USING_NORMAL_MAP{ renderMode == finalColour && (isShowingNormalMap || IS_USING_SPECULAR) };
+			static constexpr bool IS_USING_TEXTURES{ IS_USING_DIFFUSE || IS_USING_SPECULAR || IS_USING_NORMAL_MAP };
+		};
+
+		//------ Visibility Buffer ------
+		//the raster pass only writes depth & which triangle covers a pixel, a second pass shades every pixel once
+		//a visibility id is the binning job & the index in the bin of its tile, a bin holds at most a whole fan per triangle of its job
+		static constexpr uint32_t VISIBILITY_BIN_BITS{ 15 };
+		static_assert(BINNING_JOB_TRIANGLES * (MAX_CLIPPED_VERTICES - 2) <= (1u << VISIBILITY_BIN_BITS), "bin index doesn't fit in a visibility id");
+		static constexpr uint32_t EMPTY_VISIBILITY_ID{ UINT32_MAX };
+
+		//depth pre-pass & raster pass of the visibility buffer, nothing gets interpolated or shaded
+		template<bool isWritingVisibility>
+		struct DepthPipeline
+		{
+			static constexpr bool IS_SHADING{ false };
+			static constexpr bool IS_WRITING_VISIBILITY{ isWritingVisibility };
+			static constexpr bool IS_TESTING_EQUAL_DEPTH{ false };
+		};
+
+		//shading pass after a depth pre-pass, the depth buffer is final => only the closest triangle of a pixel shades it
+		template<typename Pipeline>
+		struct EqualDepthPipeline : Pipeline
+		{
+			static constexpr bool IS_TESTING_EQUAL_DEPTH{ true };
+		};
+
+		using TileFunction = void (Renderer::*)(uint32_t tileIdx, const Int2& tileMin, const Int2& tileMax);
+
+		//picks the instantiations of the current modes, once per frame
+		void SelectPixelPipeline();
+		template<typename Float>
+		void SelectPixelPipeline();
+		template<typename Float, ShadingMode shadingMode>
+		void SelectPixelPipeline();
+		template<typename Float, typename Pipeline>
+		void UsePixelPipeline();
+
+		template<typename Float, typename Pipeline>
+		void ShadeTile(uint32_t tileIdx, const Int2& tileMin, const Int2& tileMax);
+
+		//attribute / w is linear in screen space => value(x, y) = origin + stepX * (x - x0) + stepY * (y - y0), (x0, y0) is the first vertex
+		struct AttributePlane
+		{
+			float origin{};
+			float stepX{};
+			float stepY{};
+		};
+
+		//per triangle constants, computed once before the pixel loop
+		struct TriangleSetup
+		{
+			const Vertex_Out* pVertices[3]{};
+			float invTriangleArea{};
+			float depths[3]{};
+			uint32_t visibilityId{};
+
+			//only the planes of the attributes the pipeline reads get set up
+			AttributePlane invW{};
+			AttributePlane uv[2]{};
+			AttributePlane normal[3]{};
+			AttributePlane tangent[3]{};
+			AttributePlane viewDirection[3]{};
+		};
+
+		TriangleSetup SetupTriangle(const Vertex_Out& v0, const Vertex_Out& v1, const Vertex_Out& v2, uint32_t visibilityId) const;
+		//once per shaded triangle => a pixel only needs a few multiply-adds per attribute & one reciprocal
+		template<typename Pipeline>
+		void SetupAttributePlanes(TriangleSetup& triangle) const;
+		//clipped triangles live in the scratch buffer of their binning job
+		void GetBinnedVertices(uint32_t binningJobIdx, const BinnedTriangle& triangle, const Vertex_Out* pVertices[3]) const;
+
+		//recomputes the max depth of a raster block after its depth changed
+		void UpdateCoarseDepth(int blockX, int blockY);
+
+		//a block is Float::BlockWidth x 2 pixels with its top left pixel at (px, py), true when it stored depth
+		template<typename Float, typename Pipeline>
+		bool ProcessRenderedTriangle(const TriangleSetup& triangle, Float w0, Float w1, Float w2, Float mask, int px, int py);
+		//interpolates, shades & writes the lanes of laneMask, the attribute planes of the triangle are set up
+		template<typename Float, typename Pipeline>
+		void ShadePixels(const TriangleSetup& triangle, Float zBufferValue, int laneMask, int px, int py);
+		template<typename Float>
+		Float LoadBlock(const float* pBuffer, int px, int py) const;
+		template<typename Float>
+		void StoreBlock(const Float& value, float* pBuffer, int px, int py) const;
+
 		SDL_Window* m_pWindow{};
 
 		SDL_Surface* m_pFrontBuffer{ nullptr };
+		//the window surface itself when its pixels are 32 bit with 8 bit channels => no blit
 		SDL_Surface* m_pBackBuffer{ nullptr };
 		uint32_t* m_pBackBufferPixels{};
+		Simd::PixelFormat m_PixelFormat{};
 
 		float* m_pDepthBufferPixels{};
+		//max depth of every raster block => a triangle behind it can't pass the depth test in there
+		float* m_pCoarseDepthBuffer{};
+		int m_CoarseDepthWidth{};
+		uint32_t* m_pVisibilityBufferPixels{};
 
 		Camera m_Camera{};
 
@@ -101,14 +321,37 @@ namespace dae
 		bool m_IsRotating{ true };
 		bool m_IsShowingNormalMap{ true };
 
-		Texture* m_pDiffuseTexture{ nullptr };
-		Texture* m_pGlossTexture{ nullptr };
-		Texture* m_pNormalTexture{ nullptr };
-		Texture* m_pSpecularTexture{ nullptr };
+		MaterialTexture* m_pMaterialTexture{ nullptr };
 
 		std::vector<Mesh> m_MeshesObject;
 
+		ThreadPool* m_pThreadPool{ nullptr };
+
+		int m_TileCountX{};
+		int m_TileCountY{};
+		uint32_t m_ClearColour{};
+
+		//vertex stage output of every mesh back to back, it only grows => no allocations once every mesh got transformed
+		std::vector<Vertex_Out> m_TransformedVertices;
+		//where the vertices of each mesh start in m_TransformedVertices
+		std::vector<uint32_t> m_FirstTransformedVertexIndices{};
+		std::vector<VertexJob> m_VertexJobs{};
+		std::vector<BinningJob> m_BinningJobs{};
+		//one bin per tile per binning job => [binningJobIdx * tileCount + tileIdx]
+		std::vector<TileBin> m_TileBins{};
+		//triangles made by clipping, one scratch buffer per binning job
+		std::vector<ClippedVertices> m_ClippedVertices{};
+		//reset at the start of every frame, every binning job allocates from a sub arena of its own => no locking
+		FrameArena* m_pFrameArena{ nullptr };
+		std::vector<FrameArena*> m_pBinningArenas{};
+
 		RenderMode m_RenderMode{};
 		ShadingMode m_ShadingMode{};
+		SimdMode m_SimdMode{};
+		PassMode m_PassMode{};
+		uint64_t m_FrameAllocationCount{};
+		//pixel pipeline of this frame, no second pass when shading in the raster pass
+		TileFunction m_pRasterizeTile{ nullptr };
+		TileFunction m_pShadeTile{ nullptr };
 	};
 }
@@ -83,6 +83,14 @@ int main(int argc, char* args[])
 				{
 					pRenderer->ShadingModeCycling();
 				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_F8)
+				{
+					pRenderer->CullModeCycling();
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+				{
+					pRenderer->PassModeCycling();
+				}
 				break;
 			}
 		}
@@ -99,7 +107,7 @@ int main(int argc, char* args[])
 		if (printTimer >= 1.f)
 		{
 			printTimer = 0.f;
-			std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+			std::cout << "dFPS: " << pTimer->GetdFPS() << ", allocations per frame: " << pRenderer->GetFrameAllocationCount() << std::endl;
 		}
 
 		//Save screenshot after full render
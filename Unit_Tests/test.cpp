@@ -1,5 +1,11 @@
 #include "gtest/gtest.h"
+#include "BlockCompression.h"
+#include "FrameArena.h"
 #include "Maths.h"
+#include "SimdMath.h"
+#include "TexelLayout.h"
+#include "ThreadPool.h"
+#include "Utils.h"
 
 
 namespace dae
@@ -9,4 +15,411 @@ namespace dae
 		EXPECT_TRUE(true);
 	}
 
+	TEST(ThreadPool, ParallelForVisitsEveryIndexOnce) {
+		ThreadPool threadPool{ 4 };
+		EXPECT_EQ(threadPool.GetThreadCount(), 4u);
+
+		//dispatch a few times in a row, every generation has to finish before the next one starts
+		for (uint32_t count : { 0u, 1u, 7u, 1000u, 3u })
+		{
+			std::vector<std::atomic<int>> visits(count);
+			threadPool.ParallelFor(count, [&visits](uint32_t index) { ++visits[index]; });
+
+			for (const std::atomic<int>& visit : visits)
+			{
+				EXPECT_EQ(visit.load(), 1);
+			}
+		}
+	}
+
+	template<typename Float>
+	void ExpectPowMatches()
+	{
+		const float bases[8]{ 0.f, 0.1f, 0.25f, 0.5f, 0.75f, 0.9f, 1.f, 0.33f };
+		const float exponents[8]{ 0.f, 1.f, 2.5f, 25.f, 10.f, 0.5f, 25.f, 7.f };
+
+		for (int offset{}; offset < 8; offset += Float::Width)
+		{
+			float result[Float::Width]{};
+			Pow(Float::Load(bases + offset), Float::Load(exponents + offset)).Store(result);
+
+			for (int lane{}; lane < Float::Width; ++lane)
+			{
+				EXPECT_NEAR(result[lane], std::pow(bases[offset + lane], exponents[offset + lane]), 1e-4f);
+			}
+		}
+	}
+
+	TEST(SimdMath, PowMatchesStdPow) {
+		ExpectPowMatches<Simd::ScalarFloat4>();
+		ExpectPowMatches<Simd::SseFloat4>();
+		ExpectPowMatches<Simd::AvxFloat8>();
+	}
+
+	TEST(SimdMath, RowsMapToLanes) {
+		const float row0[4]{ 1.f, 2.f, 3.f, 4.f };
+		const float row1[4]{ 5.f, 6.f, 7.f, 8.f };
+		float lanes[8]{};
+
+		Simd::SseFloat4::LoadRows(row0, row1).Store(lanes);
+		EXPECT_EQ(lanes[1], 2.f);
+		EXPECT_EQ(lanes[2], 5.f);
+
+		Simd::AvxFloat8::LoadRows(row0, row1).Store(lanes);
+		EXPECT_EQ(lanes[3], 4.f);
+		EXPECT_EQ(lanes[4], 5.f);
+		EXPECT_EQ((Simd::AvxFloat8::Load(lanes) > 4.5f).MoveMask(), 0xF0);
+	}
+
+	template<typename Float>
+	void ExpectPixelsPacked()
+	{
+		const float channels[8]{ 0.f, 1.f, 0.5f, 2.f, -1.f, std::nanf(""), 0.999f, 0.25f };
+		const Float channel{ Float::Load(channels) };
+		const Simd::PixelFormat format{ 0, 8, 16, 0xFF000000 };
+
+		uint32_t pixels[Float::Width]{};
+		StorePixels(channel, Float{ 0.f }, Float{ 1.f }, format, pixels);
+		for (int lane{}; lane < Float::Width; ++lane)
+		{
+			const float expected{ channels[lane] > 0.f ? std::min(channels[lane], 1.f) * 255.f : 0.f };
+			EXPECT_EQ(pixels[lane], static_cast<uint32_t>(expected) | 0xFFFF0000);
+		}
+	}
+
+	TEST(SimdMath, PixelsGetPackedLikeTruncatedBytes) {
+		ExpectPixelsPacked<Simd::ScalarFloat4>();
+		ExpectPixelsPacked<Simd::SseFloat4>();
+		ExpectPixelsPacked<Simd::AvxFloat8>();
+	}
+
+	TEST(ParseOBJ, SharesIdenticalFaceCorners) {
+		//a quad as two triangles, the diagonal corners are the same position/uv/normal
+		const std::string filename{ "ParseOBJ_SharesIdenticalFaceCorners.obj" };
+		{
+			std::ofstream file{ filename };
+			file << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+				<< "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+				<< "vn 0 0 1\n"
+				<< "f 1/1/1 2/2/1 3/3/1\n"
+				<< "f 1/1/1 3/3/1 4/4/1\n";
+		}
+
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		ASSERT_TRUE(Utils::ParseOBJ(filename, vertices, indices, false));
+		std::remove(filename.c_str());
+
+		EXPECT_EQ(vertices.size(), 4u);
+		EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+		EXPECT_EQ(vertices[3].position, (Vector3{ 0.f, 1.f, 0.f }));
+	}
+
+	TEST(ParseOBJ, TriangulatesPolygonsAndResolvesNegativeIndices) {
+		const std::string filename{ "ParseOBJ_TriangulatesPolygonsAndResolvesNegativeIndices.obj" };
+		{
+			std::ofstream file{ filename };
+			file << "o quad\r\n"
+				<< "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+				<< "usemtl red\n"
+				<< "f -4 -3 -2 -1\n"
+				<< "g pentagon\n"
+				<< "v 2 0 0\n"
+				<< "f 1 2 5 3 4\n";
+		}
+
+		std::vector<Vertex> vertices{};
+		std::vector<uint32_t> indices{};
+		std::vector<Utils::ObjGroup> groups{};
+		ThreadPool threadPool{ 2 };
+		ASSERT_TRUE(Utils::ParseOBJ(filename, vertices, indices, false, &threadPool, &groups));
+		std::remove(filename.c_str());
+
+		//quad => 2 triangles, pentagon => 3 triangles, fanned around their first corner
+		EXPECT_EQ(vertices.size(), 5u);
+		EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3, 0, 1, 4, 0, 4, 2, 0, 2, 3 }));
+
+		ASSERT_EQ(groups.size(), 2u);
+		EXPECT_EQ(groups[0].objectName, "quad");
+		EXPECT_EQ(groups[0].materialName, "red");
+		EXPECT_EQ(groups[0].indexCount, 6u);
+		EXPECT_EQ(groups[1].groupName, "pentagon");
+		EXPECT_EQ(groups[1].materialName, "red");
+		EXPECT_EQ(groups[1].firstIndex, 6u);
+		EXPECT_EQ(groups[1].indexCount, 9u);
+	}
+
+	TEST(FrameArena, MergesBlocksOnReset) {
+		FrameArena arena{ 64 };
+
+		//3 allocations that don't fit in one block of 64 bytes
+		for (int allocationIdx{}; allocationIdx < 3; ++allocationIdx)
+		{
+			void* pMemory{ arena.Allocate(48, 16) };
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(pMemory) % 16, 0u);
+		}
+		const size_t capacity{ arena.GetCapacity() };
+		EXPECT_GT(capacity, 64u);
+
+		//the next frame of the same size fits in a single block of that capacity
+		arena.Reset();
+		void* pFirst{ arena.Allocate(48, 16) };
+		arena.Allocate(48, 16);
+		arena.Allocate(48, 16);
+		EXPECT_EQ(arena.GetCapacity(), capacity);
+
+		//the block is kept & handed out again from the start
+		arena.Reset();
+		EXPECT_EQ(arena.Allocate(48, 16), pFirst);
+		EXPECT_EQ(arena.GetCapacity(), capacity);
+	}
+
+	TEST(FrameArena, VectorsGrowInSubArenas) {
+		FrameArena arena{};
+		FrameArena subArena{ arena, 256 };
+
+		std::vector<int, FrameAllocator<int>> numbers{ FrameAllocator<int>{ subArena } };
+		for (int number{}; number < 1000; ++number)
+		{
+			numbers.push_back(number);
+		}
+		EXPECT_EQ(numbers[999], 999);
+
+		//the sub arena took its chunks from the root, nothing else hit the heap
+		EXPECT_EQ(subArena.GetCapacity(), 0u);
+		EXPECT_EQ(arena.GetCapacity(), FrameArena::DEFAULT_BLOCK_SIZE);
+	}
+
+	TEST(MeshCache, RoundTripsMesh) {
+		Mesh mesh{};
+		mesh.vertices.resize(3);
+		mesh.vertices[1].position = { 1.f, 2.f, 3.f };
+		mesh.vertices[2].uv = { 0.25f, 0.75f };
+		mesh.indices = { 0, 2, 1 };
+		Utils::CalculateBounds(mesh.vertices, mesh.boundsMin, mesh.boundsMax);
+		Utils::CalculateBoundingSphere(mesh.vertices, mesh.boundsMin, mesh.boundsMax, mesh.boundsCenter, mesh.boundsRadius);
+		Utils::BuildVertexStreams(mesh.vertices, mesh.vertexStreams);
+
+		const std::string filename{ "MeshCache_RoundTripsMesh.mesh" };
+		ASSERT_TRUE(Utils::SaveMeshCache(filename, mesh));
+
+		Mesh loadedMesh{};
+		const bool isLoaded{ Utils::LoadMeshCache(filename, loadedMesh) };
+		Mesh unflippedMesh{};
+		const bool isUnflippedLoaded{ Utils::LoadMeshCache(filename, unflippedMesh, false) };
+		std::remove(filename.c_str());
+		ASSERT_TRUE(isLoaded);
+		EXPECT_FALSE(isUnflippedLoaded);
+
+		//only the streams are stored, padded like the ones that were saved
+		const VertexStreams& streams{ loadedMesh.vertexStreams };
+		EXPECT_TRUE(loadedMesh.vertices.empty());
+		EXPECT_EQ(streams.vertexCount, 3u);
+		ASSERT_EQ(streams.positionX.size(), VertexStreams::PADDING);
+		ASSERT_EQ(streams.uvY.size(), VertexStreams::PADDING);
+		EXPECT_EQ((Vector3{ streams.positionX[1], streams.positionY[1], streams.positionZ[1] }), mesh.vertices[1].position);
+		EXPECT_EQ((Vector2{ streams.uvX[2], streams.uvY[2] }), mesh.vertices[2].uv);
+		EXPECT_EQ(streams.tangentZ, mesh.vertexStreams.tangentZ);
+		EXPECT_EQ(loadedMesh.indices, mesh.indices);
+		EXPECT_EQ(loadedMesh.boundsMax, (Vector3{ 1.f, 2.f, 3.f }));
+		EXPECT_EQ(loadedMesh.boundsCenter, mesh.boundsCenter);
+		EXPECT_EQ(loadedMesh.boundsRadius, mesh.boundsRadius);
+	}
+
+	TEST(MeshBounds, SphereEnclosesEveryVertex) {
+		std::vector<Vertex> vertices(4);
+		vertices[0].position = { -1.f, 0.f, 0.f };
+		vertices[1].position = { 3.f, 0.f, 0.f };
+		vertices[2].position = { 0.f, 2.f, -2.f };
+		vertices[3].position = { 3.f, 2.f, 2.f };
+
+		Vector3 boundsMin{};
+		Vector3 boundsMax{};
+		Utils::CalculateBounds(vertices, boundsMin, boundsMax);
+
+		Vector3 center{};
+		float radius{};
+		Utils::CalculateBoundingSphere(vertices, boundsMin, boundsMax, center, radius);
+
+		EXPECT_EQ(center, (Vector3{ 1.f, 1.f, 0.f }));
+		for (const Vertex& vertex : vertices)
+		{
+			EXPECT_LE((vertex.position - center).Magnitude(), radius + 1e-5f);
+		}
+		//the farthest vertex sits on the sphere
+		EXPECT_NEAR(radius, 3.f, 1e-5f);
+	}
+
+	TEST(VertexStreams, SplitsAndPadsComponents) {
+		std::vector<Vertex> vertices(3);
+		vertices[1].position = { 1.f, 2.f, 3.f };
+		vertices[2].normal = { 0.f, 1.f, 0.f };
+		vertices[2].tangent = { 1.f, 0.f, 0.f };
+		vertices[2].uv = { 0.25f, 0.75f };
+
+		VertexStreams streams{};
+		Utils::BuildVertexStreams(vertices, streams);
+
+		EXPECT_EQ(streams.vertexCount, 3u);
+		ASSERT_EQ(streams.positionX.size(), VertexStreams::PADDING);
+		EXPECT_EQ(streams.positionY[1], 2.f);
+		EXPECT_EQ(streams.positionZ[1], 3.f);
+		EXPECT_EQ(streams.normalY[2], 1.f);
+		EXPECT_EQ(streams.tangentX[2], 1.f);
+		EXPECT_EQ(streams.uvY[2], 0.75f);
+		EXPECT_EQ(streams.tangentZ.size(), VertexStreams::PADDING);
+		EXPECT_EQ(streams.positionX[VertexStreams::PADDING - 1], 0.f);
+	}
+
+	TEST(VertexOut, UnitVectorsSurviveEncoding) {
+		const Vector3 directions[]{ { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f }, { 1.f, 0.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.3f, -0.5f, -0.8f }, { -0.7f, 0.2f, 0.1f } };
+		for (const Vector3& direction : directions)
+		{
+			const Vector3 unitDirection{ direction.Normalized() };
+			const Vector3 decoded{ DecodeUnitVector(EncodeUnitVector(direction * 3.f)) };
+			EXPECT_GT(Vector3::Dot(decoded, unitDirection), 0.99999f);
+
+			//the vertex stage encodes a vector per lane
+			float lanes[Simd::AvxFloat8::Width]{};
+			Simd::EncodeUnitVector(Simd::Vector3<Simd::AvxFloat8>{ direction.x, direction.y, direction.z }).Store(lanes);
+			EXPECT_GT(Vector3::Dot(DecodeUnitVector(std::bit_cast<uint32_t>(lanes[0])), unitDirection), 0.99999f);
+		}
+		EXPECT_EQ(DecodeUnitVector(EncodeUnitVector({})).z, 1.f);
+	}
+
+	//fraction of the fetches a 32KB, 8 way LRU cache with 64 byte lines misses
+	//when a size x size texture is drawn 1:1 on screen, rotated by angle
+	static float SimulateTextureMissRate(int size, TexelLayout layout, float angle, size_t texelSize)
+	{
+		constexpr size_t lineSize{ 64 };
+		constexpr size_t wayCount{ 8 };
+		constexpr size_t setCount{ 64 };
+
+		//every set is ordered from most to least recently used
+		std::vector<size_t> cache(wayCount * setCount, SIZE_MAX);
+		const TexelAddressing addressing{ size, size, layout, texelSize };
+		const float cosAngle{ std::cos(angle) };
+		const float sinAngle{ std::sin(angle) };
+		const float center{ size / 2.f };
+
+		size_t fetchCount{};
+		size_t missCount{};
+		for (int py{}; py < size; ++py)
+		{
+			for (int px{}; px < size; ++px)
+			{
+				const float dx{ px + 0.5f - center };
+				const float dy{ py + 0.5f - center };
+				const int texelX{ static_cast<int>(std::floor(cosAngle * dx - sinAngle * dy + center)) };
+				const int texelY{ static_cast<int>(std::floor(sinAngle * dx + cosAngle * dy + center)) };
+				if (texelX < 0 || texelX >= size || texelY < 0 || texelY >= size)
+				{
+					continue;
+				}
+
+				const size_t line{ addressing.GetIndex(texelX, texelY) * texelSize / lineSize };
+				size_t* pSet{ &cache[(line % setCount) * wayCount] };
+				size_t* pWay{ std::find(pSet, pSet + wayCount, line) };
+				if (pWay == pSet + wayCount)
+				{
+					++missCount;
+					--pWay;
+				}
+
+				std::rotate(pSet, pWay, pWay + 1);
+				*pSet = line;
+				++fetchCount;
+			}
+		}
+
+		return static_cast<float>(missCount) / fetchCount;
+	}
+
+	TEST(TexelLayout, MortonMissesLessUnderRotation) {
+		//vehicle_diffuse.png is 1024x1024 RGBA8, the miss rate only depends on its size & layout
+		constexpr int textureSize{ 1024 };
+		float maxLinearMissRate{};
+		float maxMortonMissRate{};
+
+		for (const float degrees : { 0.f, 15.f, 30.f, 45.f, 60.f, 75.f, 90.f })
+		{
+			const float angle{ degrees * PI / 180.f };
+			const float linearMissRate{ SimulateTextureMissRate(textureSize, TexelLayout::Linear, angle, sizeof(uint32_t)) };
+			const float mortonMissRate{ SimulateTextureMissRate(textureSize, TexelLayout::Morton, angle, sizeof(uint32_t)) };
+			std::cout << "vehicle_diffuse rotated " << degrees << " degrees: linear " << linearMissRate * 100.f << "% misses, morton " << mortonMissRate * 100.f << "% misses\n";
+
+			maxLinearMissRate = std::max(maxLinearMissRate, linearMissRate);
+			maxMortonMissRate = std::max(maxMortonMissRate, mortonMissRate);
+		}
+
+		//a linear layout misses on every fetch walking down a column, Z-order doesn't care about the direction
+		EXPECT_LT(maxMortonMissRate * 4.f, maxLinearMissRate);
+	}
+
+	TEST(TexelLayout, MortonVisitsEveryTexelOnce) {
+		//not a multiple of the tile size => padded, bigger elements get smaller tiles
+		for (const size_t elementSize : { sizeof(uint32_t), static_cast<size_t>(16), static_cast<size_t>(32) })
+		{
+			const TexelAddressing addressing{ 100, 37, TexelLayout::Morton, elementSize };
+			std::vector<int> visits(addressing.GetTexelCount());
+			for (int y{}; y < 37; ++y)
+			{
+				for (int x{}; x < 100; ++x)
+				{
+					ASSERT_LT(addressing.GetIndex(x, y), visits.size());
+					++visits[addressing.GetIndex(x, y)];
+				}
+			}
+
+			EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), 100 * 37);
+			EXPECT_EQ(std::count(visits.begin(), visits.end(), 0), static_cast<long long>(visits.size()) - 100 * 37);
+		}
+	}
+
+	TEST(BlockCompression, Bc1KeepsTwoColorBlocks) {
+		//colors RGB565 can hold exactly => they have to come back unchanged
+		const uint32_t color0{ Rgb565ToTexel(0xF81F) };
+		const uint32_t color1{ Rgb565ToTexel(0x07E0) };
+		uint32_t texels[16]{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			texels[texelIdx] = (texelIdx % 3 == 0) ? color0 : color1;
+		}
+
+		const Bc1Block block{ EncodeBc1(texels) };
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			EXPECT_EQ(DecodeBc1(block, texelIdx), texels[texelIdx]);
+		}
+	}
+
+	TEST(BlockCompression, Bc3AlphaStaysWithinOneStep) {
+		//flat color, alpha ramps over the whole range
+		uint32_t texels[16]{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			texels[texelIdx] = (Rgb565ToTexel(0x7BEF) & 0x00FFFFFF) | (static_cast<uint32_t>(texelIdx * 17) << 24);
+		}
+
+		const Bc3Block block{ EncodeBc3(texels) };
+		float accumulated[4]{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			const uint32_t texel{ DecodeBc3(block, texelIdx) };
+			EXPECT_EQ(texel & 0x00FFFFFF, texels[texelIdx] & 0x00FFFFFF);
+			//half of the 255 / 7 between two alphas
+			EXPECT_NEAR(static_cast<float>(texel >> 24), static_cast<float>(texels[texelIdx] >> 24), 255.f / 14.f);
+
+			AccumulateBc3(block, texelIdx, 1.f / 16.f, accumulated);
+		}
+
+		//the filtering path decodes the same texels, up to rounding
+		float averageAlpha{};
+		for (int texelIdx{}; texelIdx < 16; ++texelIdx)
+		{
+			averageAlpha += (DecodeBc3(block, texelIdx) >> 24) / 16.f;
+		}
+		EXPECT_NEAR(accumulated[3], averageAlpha, 0.5f);
+		EXPECT_NEAR(accumulated[0], static_cast<float>(texels[0] & 0xFF), 0.5f);
+	}
 }